@@ -0,0 +1,56 @@
+#include "animacoes.h"
+#include "np_layout.h"
+
+// Animação do coração: acende o contorno ponto a ponto e depois apaga na ordem inversa.
+// As posições são (x, y), convertidas para índices na compilação por NP_XY().
+static const npColor_t paleta_coracao[] = {
+    {0, 0, 0},  // Apagado
+    {10, 0, 0}, // Vermelho
+};
+
+static const npFrame_t quadros_coracao[] = {
+    // Coração aparecendo
+    NP_FRAME(100, 0, {NP_XY(2, 0), 1}), // Base do coração
+    NP_FRAME(100, 0, {NP_XY(1, 1), 1}),
+    NP_FRAME(100, 0, {NP_XY(3, 1), 1}), // Meio inferior
+    NP_FRAME(100, 0, {NP_XY(0, 2), 1}),
+    NP_FRAME(100, 0, {NP_XY(4, 2), 1}), // Laterais
+    NP_FRAME(100, 0, {NP_XY(0, 3), 1}),
+    NP_FRAME(100, 0, {NP_XY(2, 3), 1}),
+    NP_FRAME(100, 0, {NP_XY(4, 3), 1}), // Meio superior
+    NP_FRAME(100, 0, {NP_XY(1, 4), 1}),
+    NP_FRAME(600, 0, {NP_XY(3, 4), 1}), // Topo, mantém o coração aceso por um tempo
+    // Apaga o coração gradualmente
+    NP_FRAME(100, 0, {NP_XY(3, 4), 0}),
+    NP_FRAME(100, 0, {NP_XY(1, 4), 0}),
+    NP_FRAME(100, 0, {NP_XY(4, 3), 0}),
+    NP_FRAME(100, 0, {NP_XY(2, 3), 0}),
+    NP_FRAME(100, 0, {NP_XY(0, 3), 0}),
+    NP_FRAME(100, 0, {NP_XY(4, 2), 0}),
+    NP_FRAME(100, 0, {NP_XY(0, 2), 0}),
+    NP_FRAME(100, 0, {NP_XY(3, 1), 0}),
+    NP_FRAME(100, 0, {NP_XY(1, 1), 0}),
+    NP_FRAME(100, 0, {NP_XY(2, 0), 0}),
+};
+
+const npAnimation_t anim_coracao = {
+    paleta_coracao, quadros_coracao, NP_ARRAY_SIZE(quadros_coracao), 1, 0};
+
+// Coração inteiro num sprite 5x5: o mesmo contorno da animação acima.
+const npSprite_t sprite_coracao = NP_SPRITE5(
+    NP_ROW5(0, 1, 0, 1, 0),
+    NP_ROW5(1, 0, 1, 0, 1),
+    NP_ROW5(1, 0, 0, 0, 1),
+    NP_ROW5(0, 1, 0, 1, 0),
+    NP_ROW5(0, 0, 1, 0, 0));
+
+// Peças de Tetris na orientação inicial; bit y * w + x, linha de baixo primeiro.
+const npSprite_t sprites_tetromino[7] = {
+    {4, 1, 0x0F},        // I  ####
+    {2, 2, 0x0F},        // O  ##/##
+    {3, 2, 0x02 | 0x38}, // T  ###/.#.
+    {3, 2, 0x03 | 0x30}, // S  .##/##.
+    {3, 2, 0x06 | 0x18}, // Z  ##./.##
+    {3, 2, 0x07 | 0x08}, // J  #../###
+    {3, 2, 0x07 | 0x20}, // L  ..#/###
+};
@@ -0,0 +1,16 @@
+#ifndef ANIMACOES_H
+#define ANIMACOES_H
+
+#include "np_anim.h"
+#include "np_delta.h"
+#include "np_sprite.h"
+
+// Animações pré-definidas, em tabelas constantes na flash.
+extern const npAnimation_t anim_coracao;
+extern const npDeltaAnim_t anim_tetrix; // Compilada de anim/tetrix.npa (np_assets.h).
+
+// Sprites de 1 bit (np_sprite.h).
+extern const npSprite_t sprite_coracao;
+extern const npSprite_t sprites_tetromino[7]; // I, O, T, S, Z, J, L
+
+#endif
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+#include "keypad_decode.h"
+#include "pio_asm.h"
+#include "pio_emu.h"
+
+// Roda o programa keypad_scan (keypad.pio) no emulador de PIO sobre uma matriz
+// 4x4 simulada, com os pinos da placa (linhas 8, 7, 6, 5 e colunas 4, 3, 2, 1),
+// e confere que keypad_decoder_feed entrega as teclas certas do mapa.
+// Sai com 1 na primeira diferença.
+
+#ifndef NP_KEYPAD_PIO_FILE
+#define NP_KEYPAD_PIO_FILE "keypad.pio"
+#endif
+
+// Mesmos pinos e mapa de Animacoes_neopixel.c.
+static const unsigned rows[4] = {8, 7, 6, 5};
+static const unsigned columns[4] = {4, 3, 2, 1};
+static const char KEY_MAP[16] = {
+    '1', '2', '3', 'A',
+    '4', '5', '6', 'B',
+    '7', '8', '9', 'C',
+    '*', '0', '#', 'D'};
+
+#define ROW_BASE 5
+#define COL_BASE 1
+
+/**
+ * Nível das colunas: uma tecla pressionada liga a GPIO da sua linha à da sua coluna.
+ */
+static uint32_t matriz(uint32_t pins, uint16_t pressed)
+{
+    uint32_t in = 0;
+
+    for (unsigned i = 0; i < 16; i++)
+        if ((pressed >> i) & 1 && (pins >> rows[i / 4]) & 1)
+            in |= 1u << columns[i % 4];
+    return in;
+}
+
+/**
+ * Deixa a máquina varrer a matriz com as teclas pressed e devolve a última
+ * palavra que ela publicou (false se não publicou nenhuma).
+ */
+static bool varre(pio_emu_sm_t *sm, uint16_t pressed, uint32_t *word)
+{
+    bool got = false;
+
+    // Três varreduras completas bastam para ver a mudança.
+    for (unsigned i = 0; i < 3 * 136; i++)
+    {
+        sm->gpio_in = matriz(sm->pins, pressed);
+        pio_emu_step(sm);
+        while (pio_emu_rx_pop(sm, word))
+            got = true;
+    }
+    return got;
+}
+
+static int confere(pio_emu_sm_t *sm, keypad_decoder_t *d, uint16_t pressed, const char *esperado)
+{
+    keypad_change_t ch[16];
+    uint32_t word;
+    char visto[40] = "";
+
+    if (!varre(sm, pressed, &word))
+        return printf("teclas 0x%04x: a PIO não publicou a mudança\n", pressed), 1;
+
+    unsigned n = keypad_decoder_feed(d, word, KEY_MAP, ch);
+    for (unsigned i = 0; i < n; i++)
+    {
+        size_t len = strlen(visto);
+        snprintf(visto + len, sizeof(visto) - len, "%s%c%c", i ? " " : "", ch[i].down ? '+' : '-', ch[i].key);
+    }
+    if (strcmp(visto, esperado) != 0)
+        return printf("teclas 0x%04x: palavra 0x%04x deu \"%s\", esperado \"%s\"\n", pressed, word, visto, esperado), 1;
+    if (d->state != pressed)
+        return printf("teclas 0x%04x: estado 0x%04x\n", pressed, d->state), 1;
+    return 0;
+}
+
+int main(void)
+{
+    static pio_asm_program_t prog;
+    pio_emu_sm_t sm;
+    keypad_decoder_t d;
+    int falhas = 0;
+
+    if (!pio_asm_load(NP_KEYPAD_PIO_FILE, "keypad_scan", &prog))
+        return 1;
+
+    // Configuração de keypad_scan_program_init.
+    pio_emu_init(&sm, &prog);
+    sm.set_base = ROW_BASE;
+    sm.set_count = 4;
+    sm.in_base = COL_BASE;
+    sm.in_shift_right = false;
+    sm.autopush = false;
+    sm.push_threshold = 32;
+    sm.fifo_depth = PIO_EMU_FIFO_DEPTH;
+    sm.y = 0;
+
+    keypad_decoder_init(&d, rows, columns);
+
+    // Cada tecla sozinha: aperta e solta.
+    for (unsigned i = 0; i < 16; i++)
+    {
+        char down[3] = {'+', KEY_MAP[i], 0}, up[3] = {'-', KEY_MAP[i], 0};
+        falhas += confere(&sm, &d, (uint16_t)(1u << i), down);
+        falhas += confere(&sm, &d, 0, up);
+    }
+
+    // Várias teclas em linhas e colunas diferentes; a lista sai na ordem do mapa.
+    falhas += confere(&sm, &d, 1u << 0 | 1u << 15, "+1 +D");
+    falhas += confere(&sm, &d, 1u << 0 | 1u << 15 | 1u << 6, "+6");
+    falhas += confere(&sm, &d, 1u << 6 | 1u << 9, "-1 +8 -D");
+    falhas += confere(&sm, &d, 0, "-6 -8");
+
+    // Sem mudança a PIO não publica nada.
+    uint32_t word;
+    if (varre(&sm, 0, &word))
+        falhas += printf("a PIO publicou 0x%04x sem mudança nas teclas\n", word) > 0;
+
+    printf("%s\n", falhas ? "FALHOU" : "ok");
+    return falhas ? 1 : 0;
+}
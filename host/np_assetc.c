@@ -0,0 +1,586 @@
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "np_delta.h"
+#include "np_library.h"
+
+// Compilador de animações: descrições em texto (anim/*.npa) viram fluxos
+// np_delta constantes num .c gerado, tocados pelo mesmo npDeltaStep no firmware.
+// Cada quadro é codificado contra o anterior com o menor número de bytes
+// (programação dinâmica sobre SKIP/RUN/LIT, com ou sem FILL na frente).
+// Com -b também gera a imagem da partição da biblioteca (np_library.h), que vai
+// para a placa pela USB (np_stream_send -u) sem regravar o firmware.
+// Uso: np_assetc [-o np_assets.c] [-r relatorio.txt] [-b biblioteca.bin] anim/*.npa
+//
+// Formato (linhas vazias e começadas por '#' são ignoradas fora das grades):
+//   nome tetrix        identificador C: anim_tetrix (padrão: nome do arquivo)
+//   voltas 1           repetições da sequência (padrão 1)
+//   limpa              apaga a matriz ao terminar (NP_ANIM_CLEAR_END)
+//   tecla 6            tecla da animação na biblioteca (padrão: a primeira livre)
+//   cor . 0 0 0        caractere da grade e cor R G B; na ordem, formam a paleta
+//   quadro 400         duração em ms; as linhas seguintes são a grade, a de cima
+//                      primeiro, até uma linha vazia ou a próxima palavra-chave
+
+#define MAX_CELLS 4096 // Mesmo limite de np_layout.h.
+#define MAX_CORES 94   // Caracteres imprimíveis sem o espaço.
+#define INF 0x7FFFFFFF
+
+typedef struct
+{
+    char nome[64];
+    const char *arquivo;
+    unsigned voltas, flags;
+    char tecla; // 0: a primeira livre na biblioteca.
+    char cor_ch[MAX_CORES];
+    unsigned cor_rgb[MAX_CORES][3];
+    int ncores;
+    int w, h;
+    int quadros;
+    unsigned *ms;     // Duração de cada quadro.
+    uint8_t *grades;  // quadros * w * h índices na paleta, em ordem de varredura (y = 0 embaixo).
+    uint8_t *fluxo;   // Fluxo np_delta gerado.
+    size_t fluxo_len;
+    size_t *inicio;   // Posição de cada quadro no fluxo.
+} anim_t;
+
+static const char *arquivo_atual;
+static int linha_atual;
+
+static void erro(const char *fmt, ...)
+{
+    va_list ap;
+
+    fprintf(stderr, "%s:%d: ", arquivo_atual, linha_atual);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(1);
+}
+
+static void *cresce(void *p, size_t n)
+{
+    p = realloc(p, n);
+    if (!p)
+    {
+        perror("realloc");
+        exit(1);
+    }
+    return p;
+}
+
+/**
+ * Palavra-chave no começo da linha (seguida de espaço ou do fim da linha).
+ */
+static bool chave(const char *linha, const char *k)
+{
+    size_t n = strlen(k);
+    return strncmp(linha, k, n) == 0 && (linha[n] == '\0' || linha[n] == ' ' || linha[n] == '\t');
+}
+
+static bool ehChave(const char *linha)
+{
+    return chave(linha, "nome") || chave(linha, "voltas") || chave(linha, "limpa") || chave(linha, "cor") ||
+           chave(linha, "quadro") || chave(linha, "tecla");
+}
+
+static int indiceCor(const anim_t *a, char c)
+{
+    for (int i = 0; i < a->ncores; i++)
+        if (a->cor_ch[i] == c)
+            return i;
+    return -1;
+}
+
+/**
+ * Lê um .npa inteiro.
+ */
+static void carrega(anim_t *a, const char *caminho)
+{
+    FILE *f = fopen(caminho, "r");
+    char linha[MAX_CELLS + 64];
+    char *grade[64];
+    int linhas_grade = 0;
+    bool em_grade = false;
+
+    if (!f)
+    {
+        perror(caminho);
+        exit(1);
+    }
+    memset(a, 0, sizeof(*a));
+    a->arquivo = caminho;
+    a->voltas = 1;
+    arquivo_atual = caminho;
+    linha_atual = 0;
+
+    // Nome padrão: o do arquivo, sem diretório nem extensão.
+    const char *base = strrchr(caminho, '/');
+    snprintf(a->nome, sizeof(a->nome), "%s", base ? base + 1 : caminho);
+    a->nome[strcspn(a->nome, ".")] = '\0';
+
+    for (bool fim = false; !fim;)
+    {
+        fim = !fgets(linha, sizeof(linha), f);
+        if (fim)
+            linha[0] = '\0';
+        else
+            linha_atual++;
+        linha[strcspn(linha, "\r\n")] = '\0';
+
+        if (em_grade && linha[0] && !ehChave(linha))
+        {
+            if (linhas_grade == 64)
+                erro("grade com mais de 64 linhas");
+            grade[linhas_grade++] = strdup(linha);
+            continue;
+        }
+        if (em_grade)
+        {
+            // Fim da grade: confere o tamanho e converte para ordem de varredura.
+            if (linhas_grade == 0)
+                erro("quadro sem grade");
+            int w = (int)strlen(grade[0]), h = linhas_grade;
+            if (a->quadros == 1)
+            {
+                a->w = w;
+                a->h = h;
+                if (w * h > MAX_CELLS)
+                    erro("grade com mais de %d posições", MAX_CELLS);
+            }
+            else if (w != a->w || h != a->h)
+                erro("a grade do quadro anterior tem tamanho diferente da primeira");
+            a->grades = cresce(a->grades, (size_t)a->quadros * w * h);
+            uint8_t *g = &a->grades[(size_t)(a->quadros - 1) * w * h];
+            for (int r = 0; r < h; r++)
+            {
+                if ((int)strlen(grade[r]) != w)
+                    erro("linha da grade com largura diferente: '%s'", grade[r]);
+                for (int x = 0; x < w; x++)
+                {
+                    int c = indiceCor(a, grade[r][x]);
+                    if (c < 0)
+                        erro("caractere fora da paleta na linha '%s'", grade[r]);
+                    g[(h - 1 - r) * w + x] = (uint8_t)c;
+                }
+                free(grade[r]);
+            }
+            linhas_grade = 0;
+            em_grade = false;
+        }
+
+        char *p = linha;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '\0' || *p == '#')
+            continue;
+
+        if (chave(p, "nome"))
+        {
+            if (sscanf(p + 4, " %63[A-Za-z0-9_]", a->nome) != 1)
+                erro("nome inválido");
+        }
+        else if (chave(p, "voltas"))
+        {
+            if (sscanf(p + 6, "%u", &a->voltas) != 1 || a->voltas == 0 || a->voltas > 255)
+                erro("voltas: 1 a 255");
+        }
+        else if (chave(p, "limpa"))
+            a->flags |= NP_ANIM_CLEAR_END;
+        else if (chave(p, "tecla"))
+        {
+            if (sscanf(p + 5, " %c", &a->tecla) != 1 || npLibKeyIndex(a->tecla) < 0)
+                erro("tecla: uma de %s", NP_LIB_KEY_CHARS);
+        }
+        else if (chave(p, "cor"))
+        {
+            char c;
+            unsigned *rgb = a->cor_rgb[a->ncores];
+            if (a->ncores == MAX_CORES)
+                erro("mais de 94 cores");
+            if (a->quadros)
+                erro("cor depois do primeiro quadro");
+            if (sscanf(p + 3, " %c %u %u %u", &c, &rgb[0], &rgb[1], &rgb[2]) != 4 || rgb[0] > 255 || rgb[1] > 255 ||
+                rgb[2] > 255)
+                erro("esperado: cor <caractere> <r> <g> <b>");
+            if (indiceCor(a, c) >= 0)
+                erro("caractere '%c' repetido na paleta", c);
+            a->cor_ch[a->ncores++] = c;
+        }
+        else if (chave(p, "quadro"))
+        {
+            unsigned ms;
+            if (sscanf(p + 6, "%u", &ms) != 1 || ms > 0xFFFF)
+                erro("esperado: quadro <ms> (até 65535)");
+            if (a->ncores == 0)
+                erro("quadro antes da paleta");
+            if (a->quadros == 0xFFFF)
+                erro("mais de 65535 quadros");
+            a->ms = cresce(a->ms, sizeof(unsigned) * (a->quadros + 1));
+            a->ms[a->quadros++] = ms;
+            em_grade = true;
+        }
+        else
+            erro("linha não reconhecida: '%s'", p);
+    }
+    fclose(f);
+
+    if (a->quadros == 0)
+        erro("nenhum quadro");
+}
+
+// Operações escolhidas pela programação dinâmica.
+enum
+{
+    OP_SKIP,
+    OP_RUN,
+    OP_LIT,
+};
+
+/**
+ * Codifica as posições que mudam de atual (-1 = desconhecido) para alvo com o
+ * menor fluxo SKIP/RUN/LIT + END. Retorna o tamanho; escreve em out se não for NULL.
+ */
+static size_t codificaMudancas(uint8_t *out, const uint8_t *alvo, const int *atual, int n)
+{
+    static int custo[MAX_CELLS + 1], op[MAX_CELLS + 1], op_len[MAX_CELLS + 1];
+
+    custo[0] = 0;
+    for (int i = 1; i <= n; i++)
+        custo[i] = INF;
+    for (int i = 0; i < n; i++)
+    {
+        if (custo[i] == INF)
+            continue;
+        // Trechos de até 64 posições a partir de i: SKIP se nada muda, RUN se a cor é uma só.
+        bool skip = true, corrida = true;
+        for (int k = 1; k <= 64 && i + k <= n; k++)
+        {
+            int j = i + k;
+            skip = skip && atual[j - 1] == alvo[j - 1];
+            corrida = corrida && alvo[j - 1] == alvo[i];
+            if (skip && custo[i] + 1 < custo[j])
+            {
+                custo[j] = custo[i] + 1;
+                op[j] = OP_SKIP;
+                op_len[j] = k;
+            }
+            if (corrida && custo[i] + 2 < custo[j])
+            {
+                custo[j] = custo[i] + 2;
+                op[j] = OP_RUN;
+                op_len[j] = k;
+            }
+            if (custo[i] + 1 + k < custo[j])
+            {
+                custo[j] = custo[i] + 1 + k;
+                op[j] = OP_LIT;
+                op_len[j] = k;
+            }
+        }
+    }
+
+    // O quadro pode parar em qualquer ponto a partir do qual nada muda.
+    int fim = n, melhor = n;
+    while (fim > 0 && atual[fim - 1] == alvo[fim - 1])
+        fim--;
+    for (int i = fim; i <= n; i++)
+        if (custo[i] < custo[melhor])
+            melhor = i;
+
+    size_t len = (size_t)custo[melhor] + 1;
+    if (out)
+    {
+        size_t pos = len - 1;
+        out[pos] = NPD_END;
+        for (int j = melhor; j > 0; j -= op_len[j])
+        {
+            int k = op_len[j], i = j - k;
+            if (op[j] == OP_SKIP)
+                out[--pos] = (uint8_t)NPD_SKIP(k);
+            else if (op[j] == OP_RUN)
+            {
+                out[--pos] = alvo[i];
+                out[--pos] = (uint8_t)(NPD_OP_RUN | (k - 1));
+            }
+            else
+            {
+                pos -= (size_t)k;
+                memcpy(&out[pos], &alvo[i], (size_t)k);
+                out[--pos] = (uint8_t)NPD_LIT(k);
+            }
+        }
+    }
+    return len;
+}
+
+/**
+ * Gera o fluxo de todos os quadros. O primeiro parte de um estado desconhecido
+ * (a animação pode começar depois de qualquer outra ou repetir), então define
+ * todas as posições; os demais só o que muda, com FILL quando sai mais curto.
+ */
+static void compila(anim_t *a)
+{
+    int n = a->w * a->h;
+    static int atual[MAX_CELLS], cheio[MAX_CELLS];
+    static uint8_t tmp[4 * MAX_CELLS];
+
+    for (int i = 0; i < n; i++)
+        atual[i] = -1;
+    a->inicio = cresce(NULL, sizeof(size_t) * a->quadros);
+
+    for (int q = 0; q < a->quadros; q++)
+    {
+        const uint8_t *alvo = &a->grades[(size_t)q * n];
+        size_t melhor = codificaMudancas(NULL, alvo, atual, n);
+        int melhor_cor = -1;
+
+        for (int c = 0; c < a->ncores; c++)
+        {
+            for (int i = 0; i < n; i++)
+                cheio[i] = c;
+            size_t len = 2 + codificaMudancas(NULL, alvo, cheio, n);
+            if (len < melhor)
+            {
+                melhor = len;
+                melhor_cor = c;
+            }
+        }
+
+        size_t len = 0;
+        tmp[len++] = (uint8_t)(a->ms[q] & 0xFF);
+        tmp[len++] = (uint8_t)(a->ms[q] >> 8);
+        if (melhor_cor >= 0)
+        {
+            tmp[len++] = NPD_OP_FILL;
+            tmp[len++] = (uint8_t)melhor_cor;
+            for (int i = 0; i < n; i++)
+                cheio[i] = melhor_cor;
+            len += codificaMudancas(&tmp[len], alvo, cheio, n);
+        }
+        else
+            len += codificaMudancas(&tmp[len], alvo, atual, n);
+
+        a->inicio[q] = a->fluxo_len;
+        a->fluxo = cresce(a->fluxo, a->fluxo_len + len);
+        memcpy(&a->fluxo[a->fluxo_len], tmp, len);
+        a->fluxo_len += len;
+        for (int i = 0; i < n; i++)
+            atual[i] = alvo[i];
+    }
+}
+
+static void escreveC(FILE *f, anim_t *as, int n)
+{
+    fprintf(f, "// Gerado por host/np_assetc.c; não editar (altere o .npa).\n");
+    for (int k = 0; k < n; k++)
+        fprintf(f, "//   %s\n", as[k].arquivo);
+    fprintf(f, "#include \"np_assets.h\"\n");
+
+    for (int k = 0; k < n; k++)
+    {
+        const anim_t *a = &as[k];
+
+        fprintf(f, "\n// %s: grade %dx%d, %d quadros.\n", a->nome, a->w, a->h, a->quadros);
+        fprintf(f, "static const npColor_t paleta_%s[] = {\n", a->nome);
+        for (int c = 0; c < a->ncores; c++)
+            fprintf(f, "    {%u, %u, %u}, // '%c'\n", a->cor_rgb[c][0], a->cor_rgb[c][1], a->cor_rgb[c][2], a->cor_ch[c]);
+        fprintf(f, "};\n\nstatic const uint8_t quadros_%s[] = {", a->nome);
+        for (int q = 0; q < a->quadros; q++)
+        {
+            size_t fim = q + 1 < a->quadros ? a->inicio[q + 1] : a->fluxo_len;
+            fprintf(f, "\n    // Quadro %d", q + 1);
+            for (size_t i = a->inicio[q]; i < fim; i++)
+                fprintf(f, "%s0x%02x,", (i - a->inicio[q]) % 16 == 0 ? "\n    " : " ", a->fluxo[i]);
+        }
+        fprintf(f, "\n};\n\nconst npDeltaAnim_t anim_%s = {\n", a->nome);
+        fprintf(f, "    paleta_%s, %d, quadros_%s, sizeof(quadros_%s), %d, %u, %u};\n", a->nome, a->ncores, a->nome,
+                a->nome, a->quadros, a->voltas, a->flags);
+    }
+
+    fprintf(f, "\nconst npDeltaAnim_t *const np_assets[] = {\n");
+    for (int k = 0; k < n; k++)
+        fprintf(f, "    &anim_%s,\n", as[k].nome);
+    fprintf(f, "};\n\nconst char *const np_asset_names[] = {\n");
+    for (int k = 0; k < n; k++)
+        fprintf(f, "    \"%s\",\n", as[k].nome);
+    fprintf(f, "};\n\nconst uint16_t np_asset_count = %d;\n", n);
+}
+
+/**
+ * Imagem da biblioteca: cabeçalho com o diretório por tecla, depois paleta e
+ * fluxo de cada animação. Os campos vão como estão na memória (o host é
+ * little-endian, como o RP2040). Retorna o tamanho da imagem.
+ */
+static size_t escreveBiblioteca(FILE *f, const anim_t *as, int n)
+{
+    static npLibHeader_t h;
+    const anim_t *por_tecla[NP_LIB_KEYS] = {0};
+    uint8_t *img;
+    size_t size = sizeof(h);
+
+    // Teclas pedidas primeiro; as demais animações ficam com as livres, na ordem.
+    for (int k = 0; k < n; k++)
+    {
+        arquivo_atual = as[k].arquivo;
+        linha_atual = 0;
+        if (as[k].w != as[0].w || as[k].h != as[0].h)
+            erro("a biblioteca tem uma grade só (%dx%d, de %s)", as[0].w, as[0].h, as[0].arquivo);
+        if (strlen(as[k].nome) >= sizeof(h.dir[0].name))
+            erro("nome '%s' longo demais para a biblioteca (até %zu letras)", as[k].nome, sizeof(h.dir[0].name) - 1);
+        if (!as[k].tecla)
+            continue;
+        int t = npLibKeyIndex(as[k].tecla);
+        if (por_tecla[t])
+            erro("tecla %c já usada por %s", as[k].tecla, por_tecla[t]->nome);
+        por_tecla[t] = &as[k];
+    }
+    for (int k = 0, t = 0; k < n; k++)
+    {
+        if (as[k].tecla)
+            continue;
+        while (t < NP_LIB_KEYS && por_tecla[t])
+            t++;
+        if (t == NP_LIB_KEYS)
+        {
+            arquivo_atual = as[k].arquivo;
+            erro("mais de %d animações na biblioteca", NP_LIB_KEYS);
+        }
+        por_tecla[t] = &as[k];
+    }
+
+    for (int k = 0; k < n; k++)
+        size += 3 * (size_t)as[k].ncores + as[k].fluxo_len;
+    if (size > NP_LIB_SIZE)
+    {
+        fprintf(stderr, "biblioteca com %zu bytes, maior que a partição (%d)\n", size, NP_LIB_SIZE);
+        exit(1);
+    }
+
+    img = cresce(NULL, size);
+    memset(&h, 0, sizeof(h));
+    h.magic = NP_LIB_MAGIC;
+    h.version = NP_LIB_VERSION;
+    h.count = (uint16_t)n;
+    h.size = (uint32_t)size;
+    h.width = (uint16_t)as[0].w;
+    h.height = (uint16_t)as[0].h;
+
+    size_t pos = sizeof(h);
+    for (int t = 0; t < NP_LIB_KEYS; t++)
+    {
+        const anim_t *a = por_tecla[t];
+        npLibEntry_t *e = &h.dir[t];
+        if (!a)
+            continue;
+        e->palette = (uint32_t)pos;
+        e->colors = (uint16_t)a->ncores;
+        for (int c = 0; c < a->ncores; c++)
+            for (int i = 0; i < 3; i++)
+                img[pos++] = (uint8_t)a->cor_rgb[c][i];
+        e->data = (uint32_t)pos;
+        e->size = (uint32_t)a->fluxo_len;
+        memcpy(&img[pos], a->fluxo, a->fluxo_len);
+        pos += a->fluxo_len;
+        e->frame_count = (uint16_t)a->quadros;
+        e->loops = (uint8_t)a->voltas;
+        e->flags = (uint8_t)a->flags;
+        memcpy(e->name, a->nome, strlen(a->nome) + 1); // Cabe: conferido acima.
+    }
+    memcpy(img, &h, sizeof(h));
+    h.crc = npLibCrc32(0, img + NP_LIB_CRC_START, (uint32_t)(size - NP_LIB_CRC_START));
+    memcpy(img, &h, sizeof(h));
+
+    fwrite(img, 1, size, f);
+    free(img);
+    return size;
+}
+
+/**
+ * Relatório de tamanho: quadros sem compressão (3 bytes por posição) contra o
+ * fluxo e a paleta que vão para a flash.
+ */
+static void relatorio(FILE *f, const anim_t *as, int n)
+{
+    size_t total_bruto = 0, total_flash = 0;
+
+    fprintf(f, "%-12s %7s %5s %7s %10s %10s %7s\n", "animacao", "grade", "cores", "quadros", "bruto(B)", "flash(B)",
+            "razao");
+    for (int k = 0; k < n; k++)
+    {
+        const anim_t *a = &as[k];
+        size_t bruto = (size_t)a->quadros * a->w * a->h * 3;
+        size_t flash = a->fluxo_len + 3 * (size_t)a->ncores + sizeof(npDeltaAnim_t);
+        char grade[16];
+
+        snprintf(grade, sizeof(grade), "%dx%d", a->w, a->h);
+        fprintf(f, "%-12s %7s %5d %7d %10zu %10zu %6.1fx\n", a->nome, grade, a->ncores, a->quadros, bruto, flash,
+                (double)bruto / flash);
+        total_bruto += bruto;
+        total_flash += flash;
+    }
+    fprintf(f, "%-12s %7s %5s %7s %10zu %10zu %6.1fx\n", "total", "", "", "", total_bruto, total_flash,
+            total_flash ? (double)total_bruto / total_flash : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *saida = NULL, *rel = NULL, *bib = NULL;
+    anim_t *as = NULL;
+    int n = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            saida = argv[++i];
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            rel = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+            bib = argv[++i];
+        else
+        {
+            as = cresce(as, sizeof(anim_t) * (n + 1));
+            carrega(&as[n], argv[i]);
+            for (int k = 0; k < n; k++)
+                if (strcmp(as[k].nome, as[n].nome) == 0)
+                    erro("nome '%s' já usado por outra animação", as[n].nome);
+            compila(&as[n]);
+            n++;
+        }
+    }
+    if ((!saida && !bib) || n == 0)
+    {
+        fprintf(stderr, "uso: np_assetc [-o np_assets.c] [-r relatorio.txt] [-b biblioteca.bin] anim/*.npa\n");
+        return 2;
+    }
+
+    FILE *f;
+    if (saida)
+    {
+        if (!(f = fopen(saida, "w")))
+            return perror(saida), 1;
+        escreveC(f, as, n);
+        fclose(f);
+    }
+
+    relatorio(stdout, as, n);
+    if (bib)
+    {
+        if (!(f = fopen(bib, "wb")))
+            return perror(bib), 1;
+        size_t size = escreveBiblioteca(f, as, n);
+        if (fclose(f) != 0)
+            return perror(bib), 1;
+        printf("biblioteca: %d animacoes, %zu de %d bytes da particao\n", n, size, NP_LIB_SIZE);
+    }
+    if (rel)
+    {
+        if (!(f = fopen(rel, "w")))
+            return perror(rel), 1;
+        relatorio(f, as, n);
+        fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <string.h>
+#include "animacoes.h"
+#include "neopixel.h"
+#include "np_assets.h"
+#include "np_delta.h"
+
+// Confere o formato np_delta: as animações compiladas passam em npDeltaValidate,
+// anim_tetrix reproduz quadro a quadro a tetrix() original escrita com npSetLED
+// e fluxos corrompidos são recusados. Sai com 1 na primeira diferença.
+
+// Quadros da tetrix() original (um caractere por LED, índice físico 0..24) e a duração em ms.
+static const struct
+{
+    const char *leds;
+    int32_t ms;
+} tetrix_original[] = {
+    {".......................LL", 400},
+    {"...............LL.......L", 400},
+    {".............LLL........L", 400},
+    {".....LL.......LL.........", 400},
+    {"...LLL........L..........", 400},
+    {"...LLL........L......AA..", 400},
+    {"...LLL........L..AA..A...", 400},
+    {"...LLL.....AA.L...A..A...", 400},
+    {"...LLL.AA..A..L...A......", 400},
+    {".AALLL..A..A..L..........", 400},
+    {".AALLL..A..A..L..........", 400},
+    {".AALLL..A..A..L.......MM.", 400},
+    {".AALLL..A..A..L.MM....MM.", 400},
+    {".AALLL..A..AMML.MM.......", 400},
+    {".AALLLMMA..AMML..........", 400},
+    {".AALLLMMA..AMML......CCCC", 400},
+    {".AALLLMMA..AMMLCCCC......", 400},
+    {".AALLLMMA..AMMLCCCC.C....", 400},
+    {".AALLLMMA..AMMLCCCCCC....", 400},
+    {".AALLLMMA.CAMMLCCCCCC....", 400},
+    {".AALLLMMACCAMMLCCCCCC....", 400},
+    {"CAALLLMMACCAMMLCCCCC.....", 100},
+    {".....LMMACCAMMLCCCCC.....", 100},
+    {"..........CAMMLCCCCC.....", 100},
+    {"...............CCCCC.....", 100},
+    {".........................", 400},
+};
+
+/**
+ * Cor de um caractere de tetrix_original (ORANGE, BLUE, YELLOW e CYAN da versão original).
+ */
+static npColor_t corOriginal(char c)
+{
+    switch (c)
+    {
+    case 'L':
+        return (npColor_t){10, 5, 0};
+    case 'A':
+        return (npColor_t){0, 0, 10};
+    case 'M':
+        return (npColor_t){10, 10, 0};
+    case 'C':
+        return (npColor_t){0, 10, 10};
+    default:
+        return (npColor_t){0, 0, 0};
+    }
+}
+
+static int confereTetrix(void)
+{
+    npDeltaDecoder_t d;
+    const uint quadros = sizeof(tetrix_original) / sizeof(tetrix_original[0]);
+
+    if (anim_tetrix.frame_count != quadros)
+        return printf("tetrix: %u quadros, a original tem %u\n", anim_tetrix.frame_count, quadros), 1;
+
+    npClear();
+    npDeltaStart(&d, &anim_tetrix);
+    for (uint q = 0; q < quadros; q++)
+    {
+        int32_t ms = npDeltaNextFrame(&d);
+        if (ms != tetrix_original[q].ms)
+            return printf("tetrix quadro %u: %d ms, esperado %d\n", q + 1, ms, tetrix_original[q].ms), 1;
+        for (uint i = 0; i < LED_COUNT; i++)
+        {
+            npColor_t c = corOriginal(tetrix_original[q].leds[i]);
+            if (leds[i].R != c.r || leds[i].G != c.g || leds[i].B != c.b)
+                return printf("tetrix quadro %u LED %u: (%u, %u, %u), esperado (%u, %u, %u)\n", q + 1, i,
+                              leds[i].R, leds[i].G, leds[i].B, c.r, c.g, c.b), 1;
+        }
+    }
+    printf("tetrix: %u quadros iguais aos da versão original\n", quadros);
+    return 0;
+}
+
+static int confereRecusa(const char *caso, const uint8_t *data, uint32_t size, uint16_t frames)
+{
+    static const npColor_t paleta[] = {{0, 0, 0}, {10, 0, 0}};
+    npDeltaAnim_t a = {paleta, 2, data, size, frames, 1, 0};
+
+    if (npDeltaValidate(&a))
+        return printf("fluxo inválido aceito: %s\n", caso), 1;
+    return 0;
+}
+
+int main(void)
+{
+    int falhas = 0;
+
+    for (uint i = 0; i < np_asset_count; i++)
+        if (!npDeltaValidate(np_assets[i]))
+            falhas += printf("%s: recusada por npDeltaValidate\n", np_asset_names[i]) > 0;
+
+    falhas += confereTetrix();
+
+    // Um quadro válido de referência e variações com um defeito cada.
+    static const uint8_t ok[] = {NPD_MS(100), NPD_FILL(0), NPD_RUN(3, 1), NPD_SKIP(2), NPD_LIT(2), 1, 0, NPD_END};
+    static const uint8_t cor[] = {NPD_MS(100), NPD_RUN(3, 2), NPD_END};
+    static const uint8_t cor_fill[] = {NPD_MS(100), NPD_FILL(7), NPD_END};
+    static const uint8_t lit_curto[] = {NPD_MS(100), NPD_LIT(64), 1, 0};
+    static const uint8_t run_curto[] = {NPD_MS(100), NPD_RUN(3, 1)};
+    static const uint8_t sem_fim[] = {NPD_MS(100), NPD_RUN(3, 1)};
+    static const uint8_t duracao_curta[] = {NPD_MS(100), NPD_END, 0x64};
+    static const uint8_t sobra[] = {NPD_MS(100), NPD_END, NPD_END};
+    static const uint8_t op_desconhecido[] = {NPD_MS(100), 0x02, NPD_END};
+
+    npDeltaAnim_t valido = {NULL, 2, ok, sizeof(ok), 1, 1, 0};
+    if (!npDeltaValidate(&valido))
+        falhas += printf("fluxo válido recusado\n") > 0;
+    falhas += confereRecusa("cor fora da paleta", cor, sizeof(cor), 1);
+    falhas += confereRecusa("FILL fora da paleta", cor_fill, sizeof(cor_fill), 1);
+    falhas += confereRecusa("LIT passa do fim", lit_curto, sizeof(lit_curto), 1);
+    falhas += confereRecusa("RUN sem a cor", run_curto, sizeof(run_curto) - 1, 1);
+    falhas += confereRecusa("quadro sem NPD_END", sem_fim, sizeof(sem_fim), 1);
+    falhas += confereRecusa("duração pela metade", duracao_curta, sizeof(duracao_curta), 2);
+    falhas += confereRecusa("frame_count maior que o fluxo", ok, sizeof(ok), 2);
+    falhas += confereRecusa("bytes depois do último quadro", sobra, sizeof(sobra), 1);
+    falhas += confereRecusa("comando desconhecido", op_desconhecido, sizeof(op_desconhecido), 1);
+    falhas += confereRecusa("sem quadros", ok, sizeof(ok), 0);
+
+    printf("%s\n", falhas ? "FALHOU" : "ok");
+    return falhas ? 1 : 0;
+}
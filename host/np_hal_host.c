@@ -0,0 +1,258 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "np_hal.h"
+#include "neopixel.h"
+#include "np_host.h"
+#include "np_trace.h"
+#include "np_library.h"
+
+// Backend de host: em vez de PIO/DMA, os quadros vão para um buffer com a
+// sequência de bytes do fio, e o tempo é um relógio virtual que só anda
+// quando alguém espera (sleep, prazo do escalonador ou fim de envio).
+
+static uint64_t now_us = 0;
+static uint64_t ready_at_us = 0;
+static bool callback_pending = false;
+static void (*np_callback)(void) = NULL;
+
+static uint8_t *stream = NULL;
+static size_t stream_len = 0, stream_cap = 0;
+static npHostFrame_t *frames = NULL;
+static size_t frame_count = 0, frame_cap = 0;
+
+static uint32_t gpio_value = 0;
+
+// Flash simulada da partição da biblioteca (np_library.h), começando apagada.
+static uint8_t lib_flash[NP_LIB_SIZE];
+static bool lib_flash_ready = false;
+
+static void *npHostGrow(void *buf, size_t *cap, size_t need, size_t elem)
+{
+    if (need <= *cap)
+        return buf;
+    size_t n = *cap ? *cap : 1024;
+    while (n < need)
+        n *= 2;
+    buf = realloc(buf, n * elem);
+    if (buf == NULL)
+        panic("np_hal_host: sem memória");
+    *cap = n;
+    return buf;
+}
+
+/**
+ * Avança o relógio virtual; o fim de um envio dispara o callback como a interrupção do DMA.
+ */
+static void npHostSetTime(uint64_t t)
+{
+    if (callback_pending && t >= ready_at_us)
+    {
+        // O fim do envio acontece no seu próprio instante, não no de quem esperou.
+        now_us = ready_at_us > now_us ? ready_at_us : now_us;
+        callback_pending = false;
+        npTrace(NP_EV_FRAME_END, 0, (uint16_t)(frames[frame_count - 1].bytes / 3));
+        if (np_callback)
+            np_callback();
+    }
+    if (t > now_us)
+        now_us = t;
+}
+
+/**
+ * Descarta os quadros capturados e conclui o envio pendente; o relógio continua.
+ */
+void npHostReset(void)
+{
+    npHalLedWait();
+    stream_len = frame_count = 0;
+    gpio_value = 0;
+}
+
+const uint8_t *npHostStream(size_t *len)
+{
+    *len = stream_len;
+    return stream;
+}
+
+const npHostFrame_t *npHostFrames(size_t *count)
+{
+    *count = frame_count;
+    return frames;
+}
+
+void npHostAdvanceUs(uint64_t us)
+{
+    npHostSetTime(now_us + us);
+}
+
+void npHostSetGpio(uint32_t value)
+{
+    gpio_value = value;
+}
+
+void npHalLedInit(uint pin)
+{
+    (void)pin;
+}
+
+void npHalLedSend(const void *pixels, uint count)
+{
+    npHalLedWait();
+
+#if NP_PARALLEL_STRIPS
+    // Saída paralela: grava os planos de bits como vão para a FIFO (24 bytes por LED de cada fita).
+    size_t bytes = 24 * (size_t)count;
+#else
+    size_t bytes = 3 * (size_t)count;
+#endif
+    const uint8_t *src = pixels;
+    stream = npHostGrow(stream, &stream_cap, stream_len + bytes, 1);
+    frames = npHostGrow(frames, &frame_cap, frame_count + 1, sizeof(npHostFrame_t));
+
+    npHostFrame_t *f = &frames[frame_count++];
+    f->t_us = now_us;
+    f->offset = stream_len;
+    f->bytes = bytes;
+#if NP_PARALLEL_STRIPS
+    memcpy(&stream[stream_len], src, bytes);
+    stream_len += bytes;
+#else
+    // Cada npLED_t guarda G, R, B nos três primeiros bytes (palavra 0x00BBRRGG ou struct).
+    for (uint i = 0; i < count; i++, src += sizeof(npLED_t))
+    {
+        memcpy(&stream[stream_len], src, 3);
+        stream_len += 3;
+    }
+#endif
+
+    ready_at_us = now_us + (uint64_t)count * NP_HOST_PIXEL_US + NP_HOST_RESET_US;
+    f->end_us = ready_at_us;
+    callback_pending = true;
+}
+
+void npHalLedSendBlocking(const void *pixels, uint count)
+{
+    npHalLedSend(pixels, count);
+    npHalLedWait();
+}
+
+bool npHalLedIdle(void)
+{
+    return now_us >= ready_at_us;
+}
+
+void npHalLedWait(void)
+{
+    npHostSetTime(ready_at_us);
+}
+
+void npHalLedSetCallback(void (*callback)(void))
+{
+    np_callback = callback;
+}
+
+uint64_t npHalTimeUs(void)
+{
+    return now_us;
+}
+
+void npHalSleepUs(uint64_t us)
+{
+    npHostSetTime(now_us + us);
+}
+
+/**
+ * Sem interrupções no host: esperar um evento volta na hora, esperar um prazo pula até ele.
+ */
+void npHalWaitUntil(uint64_t deadline_us)
+{
+    if (deadline_us != UINT64_MAX)
+        npHostSetTime(deadline_us);
+}
+
+void npHalWake(void)
+{
+}
+
+uint32_t npHalGpioGetAll(void)
+{
+    return gpio_value;
+}
+
+const uint8_t *npHalLibBase(void)
+{
+    if (!lib_flash_ready)
+    {
+        memset(lib_flash, 0xFF, sizeof(lib_flash));
+        lib_flash_ready = true;
+    }
+    return lib_flash;
+}
+
+/**
+ * Apagar deixa os setores em 0xFF e custa NP_HOST_ERASE_US por setor no relógio virtual.
+ */
+bool npHalLibErase(uint32_t offset, uint32_t len)
+{
+    npHalLibBase();
+    if (offset % NP_LIB_SECTOR || len % NP_LIB_SECTOR || len > NP_LIB_SIZE - offset)
+        return false;
+    memset(&lib_flash[offset], 0xFF, len);
+    npHostSetTime(now_us + (uint64_t)(len / NP_LIB_SECTOR) * NP_HOST_ERASE_US);
+    return true;
+}
+
+/**
+ * Gravar só zera bits, como na NOR. Gravar um bit 1 sobre um 0 (página sem
+ * apagar) não teria efeito na placa; aqui é um erro de quem chamou.
+ */
+bool npHalLibProgram(uint32_t offset, const void *data, uint32_t len)
+{
+    const uint8_t *src = data;
+
+    npHalLibBase();
+    if (offset % NP_LIB_PAGE || len % NP_LIB_PAGE || len > NP_LIB_SIZE - offset)
+        return false;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if ((lib_flash[offset + i] & src[i]) != src[i])
+            panic("np_hal_host: gravação sobre flash não apagada (posição %u)", (unsigned)(offset + i));
+        lib_flash[offset + i] &= src[i];
+    }
+    npHostSetTime(now_us + (uint64_t)(len / NP_LIB_PAGE) * NP_HOST_PROGRAM_US);
+    return true;
+}
+
+/**
+ * Grava uma imagem de biblioteca na flash simulada, setor a setor, pelas mesmas funções da HAL.
+ */
+bool npHostLibLoad(const void *image, size_t len)
+{
+    static uint8_t page[NP_LIB_PAGE];
+    const uint8_t *src = image;
+
+    if (len > NP_LIB_SIZE)
+        return false;
+    for (uint32_t off = 0; off < len; off += NP_LIB_PAGE)
+    {
+        size_t n = len - off < NP_LIB_PAGE ? len - off : NP_LIB_PAGE;
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page, &src[off], n);
+        if ((off % NP_LIB_SECTOR == 0 && !npHalLibErase(off, NP_LIB_SECTOR)) || !npHalLibProgram(off, page, NP_LIB_PAGE))
+            return false;
+    }
+    return true;
+}
+
+void panic(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(1);
+}
@@ -0,0 +1,33 @@
+#ifndef NP_HOST_H
+#define NP_HOST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Controle e inspeção do backend de host (np_hal_host.c).
+
+// Tempo de um pixel no fio (24 bits a 800kHz) e do RESET, usados pelo relógio virtual.
+#define NP_HOST_PIXEL_US 30
+#define NP_HOST_RESET_US 100
+
+// Tempo de apagar um setor e de gravar uma página da flash simulada (np_library.h).
+#define NP_HOST_ERASE_US 45000
+#define NP_HOST_PROGRAM_US 1000
+
+typedef struct
+{
+    uint64_t t_us;   // Instante (virtual) em que o envio começou.
+    uint64_t end_us; // Fim do RESET: o próximo quadro pode começar.
+    size_t offset;   // Posição do quadro em npHostStream().
+    size_t bytes;    // Bytes enviados (3 por LED, ordem G, R, B).
+} npHostFrame_t;
+
+void npHostReset(void);
+const uint8_t *npHostStream(size_t *len);
+const npHostFrame_t *npHostFrames(size_t *count);
+void npHostAdvanceUs(uint64_t us);
+void npHostSetGpio(uint32_t value);
+bool npHostLibLoad(const void *image, size_t len);
+
+#endif
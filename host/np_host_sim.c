@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "neopixel.h"
+#include "np_layout.h"
+#include "np_text.h"
+#include "np_fire.h"
+#include "np_tween.h"
+#include "animacoes.h"
+#include "np_assets.h"
+#include "np_library.h"
+#include "np_sched.h"
+#include "np_host.h"
+#include "np_trace.h"
+
+// Roda as animações de animacoes.c no host, pelo mesmo escalonador do firmware,
+// e mostra os quadros enviados com seus instantes virtuais.
+// Uso: np_host_sim [-v] [-x passos] [-c us] [-d] [-o fluxo.bin] [-t telemetria.bin] [-b biblioteca.bin]
+//                   [coracao|fogo|tetrix|letreiro|<animacao de anim/>]
+// -x liga o crossfade entre os quadros de coracao e tetrix (np_tween.h).
+// -c soma us de CPU virtual a cada passo (renderização lenta) e -d usa NP_SCHED_DROP
+// em vez de NP_SCHED_CATCHUP, para ver o efeito nos atrasos e na duração total.
+// -o grava o estado completo da matriz (G, R, B) após cada quadro (entrada de np_pio_emu).
+// -t grava a telemetria como o firmware envia pela USB (entrada de np_trace_dump).
+// -b grava a imagem na flash simulada e toca as animações da biblioteca (np_library.h)
+// em vez das do firmware, lendo direto da partição como a placa faz pela XIP.
+
+static npTask_t tarefa;
+static FILE *saida;
+// Estado dos LEDs: cada quadro pode trazer só um prefixo da cadeia (NP_DIRTY_PREFIX).
+static uint8_t estado[3 * LED_COUNT];
+static FILE *telemetria;
+static npTask_t tarefa_telemetria;
+static uint32_t custo_us;
+static bool descarta;
+
+/**
+ * Equivalente de npTraceTask: drena os anéis para o arquivo.
+ */
+static int32_t passoTelemetria(void *ctx)
+{
+    static uint8_t buf[4 * NP_TRACE_PACKET_MAX];
+    uint len;
+
+    (void)ctx;
+    while ((len = npTraceDrain(buf, sizeof(buf))) > 0)
+        fwrite(buf, 1, len, telemetria);
+    return NP_TRACE_DRAIN_US;
+}
+
+static int32_t passoTabela(void *ctx)
+{
+    npHostAdvanceUs(custo_us);
+    int32_t ms = npAnimStep(ctx);
+    return ms < 0 ? NP_TASK_DONE : ms * 1000;
+}
+
+static int32_t passoDelta(void *ctx)
+{
+    npHostAdvanceUs(custo_us);
+    int32_t ms = npDeltaStep(ctx);
+    return ms < 0 ? NP_TASK_DONE : ms * 1000;
+}
+
+static int32_t passoFogo(void *ctx)
+{
+    npHostAdvanceUs(custo_us);
+    int32_t ms = npFireStep(ctx);
+    return ms < 0 ? NP_TASK_DONE : ms * 1000;
+}
+
+static int32_t passoLetreiro(void *ctx)
+{
+    npHostAdvanceUs(custo_us);
+    int32_t ms = npMarqueeStep(ctx);
+    return ms < 0 ? NP_TASK_DONE : ms * 1000;
+}
+
+/**
+ * Desenha um quadro como texto (a primeira linha do texto é a linha de cima da matriz).
+ */
+static void imprimeQuadro(const uint8_t *grb)
+{
+    for (int y = NP_HEIGHT - 1; y >= 0; y--)
+    {
+        printf("    ");
+        for (int x = 0; x < NP_WIDTH; x++)
+        {
+            const uint8_t *p = &grb[3 * npLayoutIndex(x, y)];
+            if (p[0] | p[1] | p[2])
+                printf("%02x%02x%02x ", p[1], p[0], p[2]);
+            else
+                printf("...... ");
+        }
+        printf("\n");
+    }
+}
+
+static void executa(const char *nome, npTaskStep_t passo, void *ctx, bool verbose)
+{
+    npWriteStats_t antes, depois;
+
+    npHostReset();
+    npClear();
+    npGetWriteStats(&antes);
+    uint64_t inicio = npHalTimeUs();
+    npSchedStart(&tarefa, passo, ctx);
+    if (descarta)
+        npSchedSetPolicy(&tarefa, NP_SCHED_DROP);
+    if (telemetria)
+        npSchedStart(&tarefa_telemetria, passoTelemetria, NULL);
+    while (npSchedActive(&tarefa))
+        npSchedRun();
+    npWaitWrite();
+    if (telemetria)
+    {
+        passoTelemetria(NULL);
+        npSchedStop(&tarefa_telemetria);
+    }
+
+    size_t n, len;
+    const npHostFrame_t *f = npHostFrames(&n);
+    const uint8_t *stream = npHostStream(&len);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        memcpy(estado, &stream[f[i].offset], f[i].bytes);
+        if (verbose)
+        {
+            printf("  quadro %zu  t=%llu us  %zu bytes\n", i, (unsigned long long)(f[i].t_us - inicio), f[i].bytes);
+            imprimeQuadro(estado);
+        }
+        if (saida)
+            fwrite(estado, 1, sizeof(estado), saida);
+    }
+
+    npGetWriteStats(&depois);
+    uint64_t fim = n ? f[n - 1].end_us - inicio : 0;
+    printf("%-8s quadros=%zu pulados=%lu bytes=%zu duracao=%llu us\n", nome, n,
+           (unsigned long)(depois.skipped - antes.skipped), len, (unsigned long long)fim);
+    if (verbose)
+    {
+        npSchedLate_t late;
+        npSchedGetLate(&tarefa, &late);
+        printf("  atraso: passos=%u max=%uus descartados=%u hist=", (unsigned)late.steps,
+               (unsigned)late.max_us, (unsigned)late.dropped);
+        for (int i = 0; i < NP_SCHED_LATE_BINS; i++)
+            printf("%u%c", late.hist[i], i + 1 < NP_SCHED_LATE_BINS ? ',' : '\n');
+    }
+}
+
+/**
+ * Carrega a biblioteca na flash simulada e toca as entradas do diretório (ou só a de nome so).
+ */
+static int executaBiblioteca(const char *caminho, const char *so, bool verbose)
+{
+    static uint8_t img[NP_LIB_SIZE];
+    npLib_t lib;
+    npDeltaDecoder_t delta;
+    npDeltaAnim_t anim;
+    FILE *f = fopen(caminho, "rb");
+
+    if (!f)
+        return perror(caminho), 1;
+    size_t len = fread(img, 1, sizeof(img), f);
+    fclose(f);
+    if (!npHostLibLoad(img, len) || !npLibOpen(&lib))
+    {
+        fprintf(stderr, "%s: biblioteca inválida para a matriz %dx%d\n", caminho, NP_WIDTH, NP_HEIGHT);
+        return 1;
+    }
+
+    for (uint k = 0; k < NP_LIB_KEYS; k++)
+    {
+        const npLibEntry_t *e = npLibFind(&lib, k);
+        if (!e || (so && strcmp(so, e->name) != 0))
+            continue;
+        npLibGetAnim(&lib, k, &anim);
+        npDeltaStart(&delta, &anim);
+        printf("tecla %c: ", NP_LIB_KEY_CHARS[k]);
+        executa(e->name, passoDelta, &delta, verbose);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = false;
+    const char *so = NULL;
+    npAnimPlayer_t tabela;
+    npDeltaDecoder_t delta;
+    npMarquee_t letreiro;
+    static npFire_t fogo;
+    static npTransition_t transicao;
+    int passos = 0;
+    static uint8_t colunas[256];
+    const char *biblioteca = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            telemetria = fopen(argv[++i], "wb");
+            if (!telemetria)
+                return perror(argv[i]), 1;
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            custo_us = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-d") == 0)
+            descarta = true;
+        else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+            passos = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            saida = fopen(argv[++i], "wb");
+            if (!saida)
+                return perror(argv[i]), 1;
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+            biblioteca = argv[++i];
+        else
+            so = argv[i];
+    }
+
+    npInit(LED_PIN);
+    if (biblioteca)
+    {
+        int r = executaBiblioteca(biblioteca, so, verbose);
+        if (saida)
+            fclose(saida);
+        if (telemetria)
+            fclose(telemetria);
+        return r;
+    }
+
+    if (!so || strcmp(so, "coracao") == 0)
+    {
+        npAnimStart(&tabela, &anim_coracao);
+        if (passos > 1)
+        {
+            npTransitionInit(&transicao, (uint8_t)passos, NP_EASE_IN_OUT);
+            npAnimSetTransition(&tabela, &transicao);
+        }
+        executa("coracao", passoTabela, &tabela, verbose);
+    }
+    if (!so || strcmp(so, "fogo") == 0)
+    {
+        npFireStart(&fogo, 60, 30, 166);
+        executa("fogo", passoFogo, &fogo, verbose);
+    }
+    if (!so || strcmp(so, "tetrix") == 0)
+    {
+        npDeltaStart(&delta, &anim_tetrix);
+        if (passos > 1)
+        {
+            npTransitionInit(&transicao, (uint8_t)passos, NP_EASE_IN_OUT);
+            npDeltaSetTransition(&delta, &transicao);
+        }
+        executa("tetrix", passoDelta, &delta, verbose);
+    }
+    if (!so || strcmp(so, "letreiro") == 0)
+    {
+        uint n = npTextColumns(colunas, sizeof(colunas), "EMBARCATECH");
+        npMarqueeStart(&letreiro, colunas, (uint16_t)n, (npColor_t){0, 0, 10}, 120, 1);
+        executa("letreiro", passoLetreiro, &letreiro, verbose);
+    }
+    // As demais animações compiladas de anim/*.npa (tetrix já foi acima).
+    for (uint i = 0; i < np_asset_count; i++)
+    {
+        if (np_assets[i] == &anim_tetrix || (so && strcmp(so, np_asset_names[i]) != 0))
+            continue;
+        npDeltaStart(&delta, np_assets[i]);
+        executa(np_asset_names[i], passoDelta, &delta, verbose);
+    }
+    if (saida)
+        fclose(saida);
+    if (telemetria)
+        fclose(telemetria);
+    return 0;
+}
@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "neopixel.h"
+#include "np_assets.h"
+#include "np_host.h"
+#include "np_library.h"
+
+// Confere a biblioteca na flash simulada (np_hal_host.c) com a imagem gerada
+// pelo build (np_assetc -b): npLibOpen recusa bits trocados e entradas ruins
+// com CRC correto, a recepção responde 'U'/'W'/'F'/'X' como np_library.h diz e
+// npLibGetAnim toca o mesmo que as animações compiladas. Sai com 1 se algo falhar.
+
+#ifndef NP_LIB_IMAGE
+#define NP_LIB_IMAGE "np_biblioteca.bin"
+#endif
+
+static uint8_t imagem[NP_LIB_SIZE];
+static size_t imagem_len;
+static uint8_t copia[NP_LIB_SIZE];
+static int falhas;
+
+#define CONFERE(cond, ...) \
+    do                     \
+    {                      \
+        if (!(cond))       \
+        {                  \
+            printf(__VA_ARGS__); \
+            printf("\n");  \
+            falhas++;      \
+        }                  \
+    } while (0)
+
+/**
+ * Grava img na flash simulada e tenta abrir.
+ */
+static bool abre(const uint8_t *img, size_t len)
+{
+    npLib_t lib;
+    return npHostLibLoad(img, len) && npLibOpen(&lib);
+}
+
+/**
+ * Cópia da imagem com o CRC refeito depois de mexer no diretório ou nos dados.
+ */
+static void refazCrc(uint8_t *img)
+{
+    npLibHeader_t *h = (npLibHeader_t *)img;
+    h->crc = npLibCrc32(0, img + NP_LIB_CRC_START, h->size - NP_LIB_CRC_START);
+}
+
+static npLibEntry_t *primeiraEntrada(uint8_t *img)
+{
+    npLibHeader_t *h = (npLibHeader_t *)img;
+    for (uint k = 0; k < NP_LIB_KEYS; k++)
+        if (h->dir[k].palette)
+            return &h->dir[k];
+    return NULL;
+}
+
+static void confereAbertura(void)
+{
+    CONFERE(abre(imagem, imagem_len), "imagem gerada pelo build recusada");
+
+    // Um bit trocado em qualquer lugar coberto pelo CRC.
+    size_t posicoes[] = {NP_LIB_CRC_START, sizeof(npLibHeader_t), imagem_len / 2, imagem_len - 1};
+    for (size_t i = 0; i < sizeof(posicoes) / sizeof(posicoes[0]); i++)
+    {
+        memcpy(copia, imagem, imagem_len);
+        copia[posicoes[i]] ^= 0x10;
+        CONFERE(!abre(copia, imagem_len), "bit trocado na posição %zu aceito", posicoes[i]);
+    }
+
+    // Entradas ruins com o CRC correto: só a validação do fluxo as pega.
+    static const char *const casos[] = {
+        "paleta menor que as cores usadas",
+        "frame_count maior que o fluxo",
+        "fluxo cortado antes do NPD_END",
+        "frame_count menor que o fluxo",
+        "fluxo fora da imagem",
+    };
+    for (uint c = 0; c < sizeof(casos) / sizeof(casos[0]); c++)
+    {
+        memcpy(copia, imagem, imagem_len);
+        npLibEntry_t *e = primeiraEntrada(copia);
+        switch (c)
+        {
+        case 0:
+            e->colors = 1;
+            break;
+        case 1:
+            e->frame_count++;
+            break;
+        case 2:
+            e->size--;
+            break;
+        case 3:
+            e->frame_count--;
+            break;
+        default:
+            e->data = (uint32_t)imagem_len - 2;
+            break;
+        }
+        refazCrc(copia);
+        CONFERE(!abre(copia, imagem_len), "entrada ruim aceita: %s", casos[c]);
+    }
+}
+
+// Canal USB simulado: o teste escreve os pacotes em rx e lê os 'A' de tx.
+static uint8_t rx[2 * (5 + 4 + NP_LIB_PAGE + 1)];
+static size_t rx_len, rx_pos;
+static uint8_t tx[64];
+static size_t tx_len;
+
+static int leRx(void *dst, uint max)
+{
+    size_t n = rx_len - rx_pos < max ? rx_len - rx_pos : max;
+    memcpy(dst, &rx[rx_pos], n);
+    rx_pos += n;
+    return (int)n;
+}
+
+static void escreveTx(const void *src, uint len)
+{
+    if (tx_len + len <= sizeof(tx))
+    {
+        memcpy(&tx[tx_len], src, len);
+        tx_len += len;
+    }
+}
+
+/**
+ * Põe um pacote no canal ('N' 'P' tipo len payload XOR); estraga o XOR se pedido.
+ */
+static void pacote(uint8_t tipo, const uint8_t *payload, uint len, bool estraga)
+{
+    uint8_t sum = 0;
+
+    rx_len = rx_pos = 0;
+    rx[rx_len++] = NP_STREAM_MAGIC0;
+    rx[rx_len++] = NP_STREAM_MAGIC1;
+    rx[rx_len++] = tipo;
+    rx[rx_len++] = (uint8_t)len;
+    rx[rx_len++] = (uint8_t)(len >> 8);
+    for (uint i = 0; i < len; i++)
+        sum ^= rx[rx_len++] = payload[i];
+    rx[rx_len++] = estraga ? (uint8_t)~sum : sum;
+}
+
+/**
+ * Tira o último 'A' da saída: estado e posição. false se não houve resposta.
+ */
+static bool resposta(uint8_t *status, uint32_t *pos)
+{
+    if (tx_len < 11)
+        return false;
+    const uint8_t *a = &tx[tx_len - 11];
+    tx_len = 0;
+    if (a[0] != NP_STREAM_MAGIC0 || a[1] != NP_STREAM_MAGIC1 || a[2] != NP_LIB_ACK)
+        return false;
+    *status = a[5];
+    *pos = a[6] | a[7] << 8 | a[8] << 16 | (uint32_t)a[9] << 24;
+    return true;
+}
+
+/**
+ * Manda um pacote, roda a recepção e confere o 'A'.
+ */
+static void envia(npLibUpload_t *u, const char *caso, uint8_t tipo, const uint8_t *payload, uint len, bool estraga,
+                  uint8_t status_esperado, uint32_t pos_esperada)
+{
+    uint8_t status;
+    uint32_t pos;
+
+    pacote(tipo, payload, len, estraga);
+    npLibUploadStep(u);
+    if (!resposta(&status, &pos))
+        CONFERE(false, "%s: sem resposta", caso);
+    else
+        CONFERE(status == status_esperado && pos == pos_esperada, "%s: A(%u, %u), esperado A(%u, %u)", caso, status,
+                (unsigned)pos, status_esperado, (unsigned)pos_esperada);
+}
+
+static void enviaPagina(npLibUpload_t *u, const char *caso, const uint8_t *img, size_t len, uint32_t off, bool estraga,
+                        uint8_t status_esperado, uint32_t pos_esperada)
+{
+    uint8_t w[4 + NP_LIB_PAGE];
+    uint n = len - off < NP_LIB_PAGE ? (uint)(len - off) : NP_LIB_PAGE;
+
+    for (uint i = 0; i < 4; i++)
+        w[i] = (uint8_t)(off >> (8 * i));
+    memcpy(w + 4, img + off, n);
+    envia(u, caso, NP_LIB_WRITE, w, 4 + n, estraga, status_esperado, pos_esperada);
+}
+
+static void confereRecepcao(void)
+{
+    static npLibUpload_t u;
+    npLib_t lib;
+    uint8_t tam[4], status;
+    uint32_t pos;
+    uint32_t len = (uint32_t)imagem_len;
+
+    for (uint i = 0; i < 4; i++)
+        tam[i] = (uint8_t)(len >> (8 * i));
+
+    // Começa com uma biblioteca diferente na partição para ver que ela é substituída.
+    memcpy(copia, imagem, imagem_len);
+    primeiraEntrada(copia)->loops ^= 0x80;
+    refazCrc(copia);
+    npHostLibLoad(copia, imagem_len);
+    npLibOpen(&lib);
+
+    tx_len = 0;
+    npLibUploadStart(&u, &lib, leRx, escreveTx);
+    CONFERE(resposta(&status, &pos) && status == NP_LIB_OK && pos == 0, "início sem A(OK, 0)");
+    CONFERE(lib.hdr != NULL, "biblioteca fechada antes do 'U'");
+
+    uint8_t grande[4] = {0, 0, 0, 0x40};
+    envia(&u, "U maior que a partição", NP_LIB_BEGIN, grande, 4, false, NP_LIB_ERR_SIZE, 0);
+    enviaPagina(&u, "W antes do U", imagem, imagem_len, 0, false, NP_LIB_ERR_ORDER, 0);
+    envia(&u, "U", NP_LIB_BEGIN, tam, 4, false, NP_LIB_OK, 0);
+    CONFERE(lib.hdr == NULL, "biblioteca ainda aberta depois do 'U'");
+
+    uint32_t paginas = (len + NP_LIB_PAGE - 1) / NP_LIB_PAGE;
+    for (uint32_t p = 0; p < paginas; p++)
+    {
+        uint32_t off = p * NP_LIB_PAGE, fim = off + NP_LIB_PAGE < len ? off + NP_LIB_PAGE : len;
+        if (p == 1)
+        {
+            enviaPagina(&u, "W com XOR errado", imagem, imagem_len, off, true, NP_LIB_ERR_PACKET, off);
+            enviaPagina(&u, "W repetida", imagem, imagem_len, off - NP_LIB_PAGE, false, NP_LIB_ERR_ORDER, off);
+            if (paginas > 2)
+                enviaPagina(&u, "W pulando uma página", imagem, imagem_len, off + NP_LIB_PAGE, false, NP_LIB_ERR_ORDER,
+                            off);
+            envia(&u, "F no meio", NP_LIB_FINISH, NULL, 0, false, NP_LIB_ERR_ORDER, off);
+        }
+        enviaPagina(&u, "W", imagem, imagem_len, off, false, NP_LIB_OK, fim);
+    }
+    envia(&u, "F", NP_LIB_FINISH, NULL, 0, false, NP_LIB_OK, len);
+    CONFERE(!npLibUploadActive(&u), "recepção ainda ativa depois do F");
+    CONFERE(lib.hdr != NULL && memcmp(npHalLibBase(), imagem, imagem_len) == 0, "imagem recebida diferente da enviada");
+
+    // Imagem com entrada ruim (CRC correto): o 'F' recusa e a biblioteca fica fechada.
+    memcpy(copia, imagem, imagem_len);
+    primeiraEntrada(copia)->frame_count++;
+    refazCrc(copia);
+    npLibUploadStart(&u, &lib, leRx, escreveTx);
+    resposta(&status, &pos);
+    envia(&u, "U (imagem ruim)", NP_LIB_BEGIN, tam, 4, false, NP_LIB_OK, 0);
+    for (uint32_t off = 0; off < len; off += NP_LIB_PAGE)
+        enviaPagina(&u, "W (imagem ruim)", copia, imagem_len, off, false, NP_LIB_OK,
+                    off + NP_LIB_PAGE < len ? off + NP_LIB_PAGE : len);
+    envia(&u, "F (imagem ruim)", NP_LIB_FINISH, NULL, 0, false, NP_LIB_ERR_IMAGE, len);
+    CONFERE(lib.hdr == NULL, "imagem ruim aberta depois do F");
+
+    // 'X' no meio: sai da recepção e npLibOpen decide o que sobrou (aqui, nada válido).
+    envia(&u, "U (desiste)", NP_LIB_BEGIN, tam, 4, false, NP_LIB_OK, 0);
+    enviaPagina(&u, "W (desiste)", imagem, imagem_len, 0, false, NP_LIB_OK, NP_LIB_PAGE);
+    envia(&u, "X", NP_STREAM_EXIT, NULL, 0, false, NP_LIB_OK, NP_LIB_PAGE);
+    CONFERE(!npLibUploadActive(&u), "recepção ainda ativa depois do X");
+    CONFERE(lib.hdr == NULL, "biblioteca pela metade aberta depois do X");
+}
+
+static void confereReproducao(void)
+{
+    npLib_t lib;
+    npDeltaAnim_t anim;
+    npDeltaDecoder_t d_lib, d_asset;
+    static npLED_t buf_lib[LED_COUNT], buf_asset[LED_COUNT];
+    uint tocadas = 0;
+
+    CONFERE(npHostLibLoad(imagem, imagem_len) && npLibOpen(&lib), "imagem gerada pelo build recusada");
+    for (uint k = 0; k < NP_LIB_KEYS; k++)
+    {
+        const npLibEntry_t *e = npLibFind(&lib, k);
+        if (!e || !npLibGetAnim(&lib, k, &anim))
+            continue;
+
+        const npDeltaAnim_t *asset = NULL;
+        for (uint i = 0; i < np_asset_count; i++)
+            if (strcmp(np_asset_names[i], e->name) == 0)
+                asset = np_assets[i];
+        if (!asset)
+        {
+            CONFERE(false, "%s: sem animação compilada com esse nome", e->name);
+            continue;
+        }
+
+        // Mesmos quadros, durações e voltas: a da biblioteca sai da flash, a outra do programa.
+        // Cada uma desenha sobre o seu próprio quadro anterior.
+        npDeltaStart(&d_asset, asset);
+        npDeltaStart(&d_lib, &anim);
+        memset(buf_lib, 0, sizeof(buf_lib));
+        memset(buf_asset, 0, sizeof(buf_asset));
+        for (uint q = 0;; q++)
+        {
+            memcpy(leds, buf_asset, sizeof(buf_asset));
+            int32_t ms_asset = npDeltaNextFrame(&d_asset);
+            memcpy(buf_asset, leds, sizeof(buf_asset));
+            memcpy(leds, buf_lib, sizeof(buf_lib));
+            int32_t ms_lib = npDeltaNextFrame(&d_lib);
+            memcpy(buf_lib, leds, sizeof(buf_lib));
+            if (ms_lib != ms_asset || memcmp(buf_asset, buf_lib, sizeof(buf_lib)) != 0)
+            {
+                CONFERE(false, "%s quadro %u: diferente da animação compilada", e->name, q + 1);
+                break;
+            }
+            if (ms_lib < 0)
+                break;
+        }
+        tocadas++;
+    }
+    CONFERE(tocadas > 0 && tocadas == ((const npLibHeader_t *)imagem)->count, "tocadas %u entradas do diretório",
+            tocadas);
+}
+
+int main(void)
+{
+    FILE *f = fopen(NP_LIB_IMAGE, "rb");
+    if (!f)
+        return perror(NP_LIB_IMAGE), 1;
+    imagem_len = fread(imagem, 1, sizeof(imagem), f);
+    fclose(f);
+
+    confereAbertura();
+    confereRecepcao();
+    confereReproducao();
+
+    printf("%s\n", falhas ? "FALHOU" : "ok");
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,307 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pio_asm.h"
+#include "pio_emu.h"
+
+// Roda o programa de ws2818b.pio ciclo a ciclo sobre um fluxo de quadros e mede
+// a forma de onda: T0H/T0L/T1H/T1L, período de bit, tempo de fio por quadro,
+// RESET e o FPS máximo. Também decodifica os bits como um WS2812 (MSB primeiro)
+// e confere com os bytes de entrada. Sai com 1 se faltar bit, se a ordem não
+// bater ou se algum tempo cair fora da janela do WS2812B (ctest np_pio_emu).
+//
+// Uso: np_pio_emu [-f arquivo.pio] [-p programa] [-b bits_autopull] [-n leds]
+//                 [-s clk_sys_hz] [-r reset_us] [-t ciclos] [-v] [fluxo.bin]
+// fluxo.bin: bytes G, R, B de quadros com n LEDs (ex.: np_host_sim -o).
+// -b: limiar do autopull quando o init o recebe como parâmetro (24 = NP_PACKED_PIXELS).
+
+#ifndef NP_PIO_FILE
+#define NP_PIO_FILE "ws2818b.pio"
+#endif
+
+// Janelas do datasheet do WS2812B (ns, 0,4/0,8us +-150ns; RESET >= 50us) e o
+// limiar de decodificação usado pelo LED. São conferidas sem folga.
+#define T0H_MIN 250
+#define T0H_MAX 550
+#define T1H_MIN 650
+#define T1H_MAX 950
+#define T0L_MIN 700
+#define T0L_MAX 1000
+#define T1L_MIN 300
+#define T1L_MAX 600
+#define RESET_MIN_US 50
+#define BIT_HIGH_LIMIAR_NS 600
+
+typedef struct
+{
+    double min, max;
+    unsigned n;
+} faixa_t;
+
+static void faixa_add(faixa_t *f, double v)
+{
+    if (f->n == 0 || v < f->min)
+        f->min = v;
+    if (f->n == 0 || v > f->max)
+        f->max = v;
+    f->n++;
+}
+
+/**
+ * Mostra a faixa medida e diz se ela cabe em lo..hi.
+ */
+static bool faixa_print(const char *nome, const faixa_t *f, int lo, int hi)
+{
+    if (f->n == 0)
+    {
+        printf("%s_ns=- ", nome);
+        return true;
+    }
+    bool ok = f->min >= lo && f->max <= hi;
+    printf("%s_ns=%.0f..%.0f%s ", nome, f->min, f->max, ok ? "" : "(FORA)");
+    return ok;
+}
+
+/**
+ * Lê do bloco c-sdk a configuração usada por *_program_init. Se o limiar do
+ * autopull vier de um parâmetro do init, *threshold mantém o valor recebido (-b).
+ */
+static bool config_do_init(const pio_asm_program_t *p, bool *right, bool *autopull, int *threshold,
+                           float *ciclos_por_bit, int *fifo)
+{
+    char a[8], b[8], n[24];
+    const char *s = strstr(p->c_sdk, "sm_config_set_out_shift(&c,");
+    if (!s || sscanf(s + 27, " %7[^,], %7[^,], %23[^)]", a, b, n) != 3)
+        return false;
+    if (n[0] >= '0' && n[0] <= '9')
+        *threshold = atoi(n);
+    *right = strcmp(a, "true") == 0;
+    *autopull = strcmp(b, "true") == 0;
+
+    s = strstr(p->c_sdk, "clock_get_hz(clk_sys) /");
+    if (!s || !(s = strchr(s, '(' )) || !(s = strchr(s + 1, '(')))
+        return false;
+    *ciclos_por_bit = strtof(s + 1, NULL);
+
+    *fifo = strstr(p->c_sdk, "PIO_FIFO_JOIN_TX") ? 8 : 4;
+    return *ciclos_por_bit > 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *pio_file = NP_PIO_FILE, *programa = "ws2818b", *fluxo = NULL;
+    unsigned leds = 25, reset_us = 100, trace = 0;
+    double sys_hz = 125e6, freq = 800000;
+    bool verbose = false;
+    int threshold = 24;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        if (a[0] != '-')
+            fluxo = a;
+        else if (strcmp(a, "-v") == 0)
+            verbose = true;
+        else if (i + 1 < argc && strcmp(a, "-f") == 0)
+            pio_file = argv[++i];
+        else if (i + 1 < argc && strcmp(a, "-p") == 0)
+            programa = argv[++i];
+        else if (i + 1 < argc && strcmp(a, "-b") == 0)
+            threshold = atoi(argv[++i]);
+        else if (i + 1 < argc && strcmp(a, "-n") == 0)
+            leds = (unsigned)atoi(argv[++i]);
+        else if (i + 1 < argc && strcmp(a, "-s") == 0)
+            sys_hz = atof(argv[++i]);
+        else if (i + 1 < argc && strcmp(a, "-r") == 0)
+            reset_us = (unsigned)atoi(argv[++i]);
+        else if (i + 1 < argc && strcmp(a, "-t") == 0)
+            trace = (unsigned)atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "uso: %s [-f arquivo.pio] [-p programa] [-b bits_autopull] [-n leds] [-s clk_sys_hz] [-r reset_us] [-t ciclos] [-v] [fluxo.bin]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (leds == 0)
+        return fprintf(stderr, "-n precisa ser maior que zero\n"), 2;
+
+    static pio_asm_program_t prog;
+    if (!pio_asm_load(pio_file, programa, &prog))
+        return 1;
+
+    bool right, autopull;
+    int fifo;
+    float ciclos_por_bit;
+    if (!config_do_init(&prog, &right, &autopull, &threshold, &ciclos_por_bit, &fifo) || threshold <= 0 || threshold > 32 || threshold % 8)
+    {
+        fprintf(stderr, "%s: configuração de %s_program_init não reconhecida\n", pio_file, programa);
+        return 1;
+    }
+
+    // Bytes de entrada: arquivo ou um quadro de teste com todos os padrões de bit.
+    uint8_t *bytes;
+    size_t len;
+    if (fluxo)
+    {
+        FILE *f = fopen(fluxo, "rb");
+        if (!f)
+            return perror(fluxo), 1;
+        fseek(f, 0, SEEK_END);
+        len = (size_t)ftell(f);
+        rewind(f);
+        bytes = malloc(len ? len : 1);
+        if (fread(bytes, 1, len, f) != len)
+            return perror(fluxo), 1;
+        fclose(f);
+    }
+    else
+    {
+        len = 3 * (size_t)leds;
+        bytes = malloc(len);
+        for (size_t i = 0; i < len; i++)
+            bytes[i] = (uint8_t)(i * 0x35 + 0x0F);
+    }
+    size_t quadro_bytes = 3 * (size_t)leds;
+    size_t quadros = len / quadro_bytes;
+    if (quadros == 0)
+        return fprintf(stderr, "fluxo menor que um quadro de %u LEDs\n", leds), 1;
+
+    pio_emu_sm_t sm;
+    pio_emu_init(&sm, &prog);
+    sm.out_shift_right = right;
+    sm.autopull = autopull;
+    sm.pull_threshold = (uint8_t)threshold;
+    sm.fifo_depth = (uint8_t)fifo;
+    float div = (float)(sys_hz / (ciclos_por_bit * freq));
+    pio_emu_set_clkdiv(&sm, div);
+
+    printf("programa=%s clk_sys_hz=%.0f clkdiv=%u+%u/256 shift=%s autopull=%d limiar=%d fifo=%d\n",
+           prog.name, sys_hz, sm.clkdiv_int, sm.clkdiv_frac, right ? "direita" : "esquerda", autopull, threshold, fifo);
+
+    // Cada palavra da FIFO leva threshold/8 bytes em ordem little-endian, como o DMA
+    // lê da memória; escritas de 8 bits replicam o byte nas quatro posições.
+    size_t por_palavra = (size_t)threshold / 8;
+    uint8_t *decod = calloc(len, 1);
+    faixa_t t0h = {0}, t1h = {0}, t0l = {0}, t1l = {0}, periodo = {0}, fio = {0}, reset = {0};
+    double ns_por_clk = 1e9 / sys_hz;
+    bool msb_ok = true, lsb_ok = true;
+    size_t bits_total = 0;
+
+    for (size_t q = 0; q < quadros; q++)
+    {
+        const uint8_t *src = &bytes[q * quadro_bytes];
+        size_t palavras = (quadro_bytes + por_palavra - 1) / por_palavra, enviadas = 0;
+        uint64_t sobe = 0, desce = 0, primeira = 0, ultima = 0;
+        size_t bit = 0;
+        bool nivel = (sm.pins >> sm.sideset_base) & 1;
+
+        while (enviadas < palavras || !(sm.stalled && sm.tx_count == 0))
+        {
+            // O DMA mantém a FIFO cheia.
+            while (enviadas < palavras)
+            {
+                uint32_t w = 0;
+                for (size_t k = 0; k < por_palavra && enviadas * por_palavra + k < quadro_bytes; k++)
+                    w |= (uint32_t)src[enviadas * por_palavra + k] << (8 * k);
+                if (por_palavra == 1)
+                    w *= 0x01010101u;
+                if (!right)
+                    w <<= 32 - threshold;
+                if (!pio_emu_tx_push(&sm, w))
+                    break;
+                enviadas++;
+            }
+
+            if (trace && sm.cycles < trace)
+            {
+                char txt[48];
+                pio_asm_disassemble(&prog, prog.instr[sm.pc], txt, sizeof(txt));
+                printf("ciclo=%llu pc=%u %-24s pino=%u%s\n", (unsigned long long)sm.cycles, sm.pc,
+                       sm.delay_left ? "(delay)" : txt, (sm.pins >> sm.sideset_base) & 1, sm.stalled ? " parada" : "");
+            }
+            pio_emu_step(&sm);
+
+            bool agora = (sm.pins >> sm.sideset_base) & 1;
+            if (agora == nivel)
+                continue;
+            nivel = agora;
+            uint64_t t = pio_emu_sys_clocks(&sm);
+            if (agora)
+            {
+                if (bit == 0)
+                    primeira = t;
+                else
+                {
+                    faixa_add(&periodo, (double)(t - sobe) * ns_por_clk);
+                    faixa_add((decod[q * quadro_bytes + (bit - 1) / 8] >> (7 - (bit - 1) % 8)) & 1 ? &t1l : &t0l,
+                              (double)(t - desce) * ns_por_clk);
+                }
+                sobe = t;
+            }
+            else
+            {
+                double alto = (double)(t - sobe) * ns_por_clk;
+                bool um = alto > BIT_HIGH_LIMIAR_NS;
+                faixa_add(um ? &t1h : &t0h, alto);
+                if (bit < quadro_bytes * 8 && um)
+                    decod[q * quadro_bytes + bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+                bit++;
+                desce = ultima = t;
+            }
+        }
+
+        // RESET: linha em nível baixo até o próximo quadro.
+        uint64_t fim = pio_emu_sys_clocks(&sm) + (uint64_t)(reset_us * sys_hz / 1e6);
+        while (pio_emu_sys_clocks(&sm) < fim)
+            pio_emu_step(&sm);
+        double fio_us = (double)(ultima - primeira) * ns_por_clk / 1000;
+        double reset_med = (double)(pio_emu_sys_clocks(&sm) - ultima) * ns_por_clk / 1000;
+        faixa_add(&fio, fio_us);
+        faixa_add(&reset, reset_med);
+        bits_total += bit;
+
+        for (size_t i = 0; i < quadro_bytes; i++)
+        {
+            uint8_t in = src[i], out = decod[q * quadro_bytes + i], rev = 0;
+            for (int k = 0; k < 8; k++)
+                rev |= (uint8_t)(((in >> k) & 1) << (7 - k));
+            msb_ok &= out == in;
+            lsb_ok &= out == rev;
+        }
+
+        printf("quadro=%zu bits=%zu fio_us=%.3f reset_us=%.3f\n", q, bit, fio_us, reset_med);
+        if (verbose)
+        {
+            printf("  grb=");
+            for (size_t i = 0; i < quadro_bytes; i++)
+                printf("%02x%s", decod[q * quadro_bytes + i], i % 3 == 2 ? " " : "");
+            printf("\n");
+        }
+    }
+
+    bool tempos_ok = faixa_print("t0h", &t0h, T0H_MIN, T0H_MAX);
+    tempos_ok &= faixa_print("t0l", &t0l, T0L_MIN, T0L_MAX);
+    tempos_ok &= faixa_print("t1h", &t1h, T1H_MIN, T1H_MAX);
+    tempos_ok &= faixa_print("t1l", &t1l, T1L_MIN, T1L_MAX);
+    tempos_ok &= reset.min >= RESET_MIN_US;
+    printf("\nbit_ns=%.0f..%.0f reset_us=%.1f%s\n", periodo.min, periodo.max, reset.min,
+           reset.min >= RESET_MIN_US ? "" : "(FORA)");
+
+    // Ordem de bits vista pelo LED: o WS2812 trata o primeiro bit como o MSB.
+    const char *ordem = msb_ok ? "msb" : lsb_ok ? "lsb" : "erro";
+    printf("bits_esperados=%zu bits_vistos=%zu ordem_bits=%s\n", quadros * quadro_bytes * 8, bits_total, ordem);
+
+    double bit_ns = periodo.n ? (periodo.min + periodo.max) / 2 : 0;
+    unsigned tamanhos[] = {leds, 25, 256, 1024};
+    for (unsigned i = 0; i < sizeof(tamanhos) / sizeof(tamanhos[0]); i++)
+    {
+        if (i > 0 && tamanhos[i] == leds)
+            continue;
+        double quadro_us = tamanhos[i] * 24 * bit_ns / 1000 + reset_us;
+        printf("leds=%u quadro_us=%.1f fps_max=%.1f\n", tamanhos[i], quadro_us, 1e6 / quadro_us);
+    }
+
+    free(bytes);
+    free(decod);
+    return bits_total == quadros * quadro_bytes * 8 && (msb_ok || lsb_ok) && tempos_ok ? 0 : 1;
+}
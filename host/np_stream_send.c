@@ -0,0 +1,570 @@
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "neopixel.h"
+#include "np_stream.h"
+#include "np_library.h"
+#include "np_host.h"
+
+// Envia quadros ao modo ao vivo da placa (np_stream.h): um cometa andando pela
+// cadeia sobre um fundo fixo, em quadros crus ou delta, com controle de fluxo
+// pelos 'K' que a placa devolve. Sem placa, -l cria um pty e um processo filho
+// faz o papel do firmware (np_stream.c com o backend de host) do outro lado.
+// Com -u envia uma biblioteca de animações (np_library.h) para a partição da
+// flash; no loopback ela é gravada na flash simulada de np_hal_host.c.
+// Uso: np_stream_send [-d] [-n quadros] [-f fps] [-w janela] [-c leds] (-l | /dev/ttyACM0)
+//      np_stream_send -u biblioteca.bin (-l | /dev/ttyACM0)
+//   -d  quadros delta (só os LEDs alterados; cru de novo depois de um descarte)
+//   -n  quadros (padrão 200)   -f  FPS alvo (padrão 0: o que a placa aceitar)
+//   -w  quadros enviados sem 'K' (padrão 2)
+//   -c  LEDs da cadeia (padrão LED_COUNT; com -l é sempre LED_COUNT)
+
+#define MAX_LEDS 4096
+
+static int fd;
+static npStreamStats_t placa; // Últimos contadores recebidos da placa.
+static bool tem_status;
+static uint8_t rx[1024];
+static size_t rx_len;
+
+static void escreveTudo(int f, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+
+    while (len)
+    {
+        ssize_t n = write(f, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            perror("write");
+            exit(1);
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+static void modoCru(int f)
+{
+    struct termios t;
+
+    if (tcgetattr(f, &t) == 0)
+    {
+        cfmakeraw(&t);
+        tcsetattr(f, TCSANOW, &t);
+    }
+}
+
+static uint32_t le32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * Procura em rx o primeiro pacote do tipo pedido com len bytes de payload e o
+ * copia para payload. O que vem antes dele (telemetria, printf do firmware e
+ * outros pacotes) é descartado; um possível começo de pacote no fim fica em rx.
+ */
+static bool extraiPacote(uint8_t tipo, uint8_t *payload, size_t len)
+{
+    size_t i = 0;
+    bool achou = false;
+
+    while (i < rx_len)
+    {
+        if (rx[i] != NP_STREAM_MAGIC0)
+        {
+            i++;
+            continue;
+        }
+        if (rx_len - i < len + 6)
+            break; // Pode ser o começo do pacote.
+        const uint8_t *p = &rx[i];
+        if (p[1] == NP_STREAM_MAGIC1 && p[2] == tipo && p[3] == len && p[4] == 0)
+        {
+            uint8_t sum = 0;
+            for (size_t k = 0; k < len; k++)
+                sum ^= p[5 + k];
+            if (sum == p[5 + len])
+            {
+                memcpy(payload, &p[5], len);
+                i += len + 6;
+                achou = true;
+                break;
+            }
+        }
+        i++;
+    }
+    memmove(rx, rx + i, rx_len - i);
+    rx_len -= i;
+    return achou;
+}
+
+/**
+ * Espera até timeout_ms por um pacote do tipo pedido (ver extraiPacote).
+ */
+static bool lePacote(int timeout_ms, uint8_t tipo, uint8_t *payload, size_t len)
+{
+    struct pollfd pfd = {fd, POLLIN, 0};
+
+    if (extraiPacote(tipo, payload, len))
+        return true;
+    if (poll(&pfd, 1, timeout_ms) <= 0)
+        return false;
+    ssize_t n = read(fd, rx + rx_len, sizeof(rx) - rx_len);
+    if (n <= 0)
+        return false;
+    rx_len += (size_t)n;
+    return extraiPacote(tipo, payload, len);
+}
+
+/**
+ * Espera até timeout_ms por dados da placa e extrai os 'K'.
+ * Retorna true se chegou algum 'K'.
+ */
+static bool leStatus(int timeout_ms)
+{
+    uint8_t p[12]; // Três contadores de 32 bits.
+
+    if (!lePacote(timeout_ms, NP_STREAM_STATUS, p, sizeof(p)))
+        return false;
+    do
+    {
+        placa.received = le32(&p[0]);
+        placa.displayed = le32(&p[4]);
+        placa.dropped = le32(&p[8]);
+    } while (extraiPacote(NP_STREAM_STATUS, p, sizeof(p)));
+    tem_status = true;
+    return true;
+}
+
+/**
+ * Completa o pacote com payload de len bytes já em p + 5; retorna o tamanho total.
+ */
+static size_t pacote(uint8_t *p, uint8_t tipo, size_t len)
+{
+    uint8_t sum = 0;
+
+    p[0] = NP_STREAM_MAGIC0;
+    p[1] = NP_STREAM_MAGIC1;
+    p[2] = tipo;
+    p[3] = (uint8_t)len;
+    p[4] = (uint8_t)(len >> 8);
+    for (size_t i = 0; i < len; i++)
+        sum ^= p[5 + i];
+    p[5 + len] = sum;
+    return len + 6;
+}
+
+/**
+ * Quadro de teste (G, R, B por LED): um ponto azul fraco a cada 5 LEDs e um
+ * cometa de 4 LEDs que anda um LED por quadro.
+ */
+static void desenha(uint8_t *grb, uint leds, uint quadro)
+{
+    memset(grb, 0, 3 * leds);
+    for (uint i = 0; i < leds; i += 5)
+        grb[3 * i + 2] = 4;
+    for (uint k = 0; k < 4 && k < leds; k++)
+    {
+        uint i = (quadro + leds - k) % leds;
+        grb[3 * i + 0] = (uint8_t)(32 >> k);
+        grb[3 * i + 1] = (uint8_t)(64 >> k);
+    }
+}
+
+/**
+ * Payload 'D': trechos { pula, n, GRB[n] } com os LEDs diferentes do quadro anterior.
+ */
+static size_t codificaDelta(uint8_t *out, const uint8_t *novo, const uint8_t *velho, uint leds)
+{
+    size_t len = 0;
+    uint i = 0, cursor = 0;
+
+    while (true)
+    {
+        while (i < leds && memcmp(&novo[3 * i], &velho[3 * i], 3) == 0)
+            i++;
+        if (i == leds)
+            break;
+        uint fim = i;
+        while (fim < leds && fim - i < 255 && memcmp(&novo[3 * fim], &velho[3 * fim], 3) != 0)
+            fim++;
+
+        uint pula = i - cursor;
+        for (; pula > 255; pula -= 255)
+        {
+            out[len++] = 255;
+            out[len++] = 0;
+        }
+        out[len++] = (uint8_t)pula;
+        out[len++] = (uint8_t)(fim - i);
+        memcpy(&out[len], &novo[3 * i], 3 * (fim - i));
+        len += 3 * (fim - i);
+        i = cursor = fim;
+    }
+    return len;
+}
+
+// Lado da placa no loopback: leitura sem bloqueio do pty, como a FIFO da USB.
+static int receptor_fd;
+
+static int leReceptor(void *dst, uint max)
+{
+    ssize_t n = read(receptor_fd, dst, max);
+    if (n > 0)
+        return (int)n;
+    return n < 0 && errno == EAGAIN ? 0 : -1;
+}
+
+static void escreveReceptor(const void *src, uint len)
+{
+    escreveTudo(receptor_fd, src, len);
+}
+
+/**
+ * Recebe uma biblioteca na flash simulada com npLibUploadStep e mostra o
+ * diretório que a placa passaria a usar.
+ */
+static int receptorBiblioteca(int s)
+{
+    static npLibUpload_t up;
+    npLib_t lib;
+    int32_t us;
+
+    npLibOpen(&lib);
+    npLibUploadStart(&up, &lib, leReceptor, escreveReceptor);
+    while ((us = npLibUploadStep(&up)) >= 0)
+    {
+        struct pollfd pfd = {s, POLLIN, 0};
+        poll(&pfd, 1, 10);
+        npHalSleepUs((uint64_t)us);
+    }
+
+    if (!lib.hdr)
+    {
+        fprintf(stderr, "receptor: nenhuma biblioteca válida na partição\n");
+        return 1;
+    }
+    fprintf(stderr, "receptor: biblioteca com %u animacoes, %u bytes, gravada em %.2f s (virtuais):",
+            lib.hdr->count, (unsigned)lib.hdr->size, npHalTimeUs() / 1e6);
+    for (uint k = 0; k < NP_LIB_KEYS; k++)
+    {
+        const npLibEntry_t *e = npLibFind(&lib, k);
+        if (e)
+            fprintf(stderr, " %c=%s", NP_LIB_KEY_CHARS[k], e->name);
+    }
+    fputc('\n', stderr);
+    return 0;
+}
+
+/**
+ * Faz o papel do firmware: espera NP_STREAM_CMD (ou NP_LIB_UPLOAD_CMD) como o
+ * laço principal e roda npStreamStep até o 'X' ou o fim da conexão. O relógio
+ * virtual anda um período de leitura por passo, então o fio e o RESET seguem o
+ * modelo de np_hal_host.c.
+ */
+static int receptor(int s)
+{
+    npStream_t st;
+    npStreamStats_t ss;
+    uint8_t c;
+    int32_t us;
+
+    receptor_fd = s;
+    do
+    {
+        if (read(s, &c, 1) != 1)
+            return 1;
+    } while (c != NP_STREAM_CMD && c != NP_LIB_UPLOAD_CMD);
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL) | O_NONBLOCK);
+    if (c == NP_LIB_UPLOAD_CMD)
+        return receptorBiblioteca(s);
+
+    npInit(LED_PIN);
+    npStreamStart(&st, leReceptor, escreveReceptor);
+    while ((us = npStreamStep(&st)) >= 0)
+    {
+        struct pollfd pfd = {s, POLLIN, 0};
+        if (!st.pending)
+            poll(&pfd, 1, 10);
+        npHalSleepUs((uint64_t)us);
+    }
+    npWaitWrite();
+
+    size_t quadros;
+    npHostFrames(&quadros);
+    npStreamGetStats(&st, &ss);
+    fprintf(stderr, "receptor: recebidos=%u exibidos=%u descartados=%u quadros_no_fio=%zu\n",
+            (unsigned)ss.received, (unsigned)ss.displayed, (unsigned)ss.dropped, quadros);
+    return 0;
+}
+
+static double agora(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Envia uma biblioteca (np_library.h): 'U', uma página por 'W' e 'F', cada
+ * pacote esperando o seu 'A'. Sem resposta ou com o pacote corrompido, reenvia;
+ * com 'W' fora de ordem (um 'A' perdido), continua de onde a placa parou.
+ */
+static int enviaBiblioteca(const uint8_t *img, uint32_t size)
+{
+    static uint8_t buf[5 + 4 + NP_LIB_PAGE + 1];
+    uint8_t a[5]; // Estado e bytes gravados.
+    uint32_t pos = 0;
+    bool iniciado = false;
+    uint reenvios = 0, falhas = 0;
+    double t0 = agora();
+
+    // A placa responde ao comando com um 'A' quando entra no modo de recepção.
+    uint8_t cmd = NP_LIB_UPLOAD_CMD;
+    escreveTudo(fd, &cmd, 1);
+    if (!lePacote(2000, NP_LIB_ACK, a, sizeof(a)))
+    {
+        fprintf(stderr, "a placa não entrou no modo de recepção\n");
+        return 1;
+    }
+
+    while (true)
+    {
+        size_t len;
+        if (!iniciado)
+        {
+            for (int i = 0; i < 4; i++)
+                buf[5 + i] = (uint8_t)(size >> (8 * i));
+            len = pacote(buf, NP_LIB_BEGIN, 4);
+        }
+        else if (pos < size)
+        {
+            uint32_t n = size - pos < NP_LIB_PAGE ? size - pos : NP_LIB_PAGE;
+            for (int i = 0; i < 4; i++)
+                buf[5 + i] = (uint8_t)(pos >> (8 * i));
+            memcpy(&buf[9], &img[pos], n);
+            len = pacote(buf, NP_LIB_WRITE, 4 + n);
+        }
+        else
+            len = pacote(buf, NP_LIB_FINISH, 0);
+        escreveTudo(fd, buf, len);
+
+        if (!lePacote(1000, NP_LIB_ACK, a, sizeof(a)) || a[0] == NP_LIB_ERR_PACKET)
+        {
+            reenvios++;
+            if (++falhas == 5)
+            {
+                fprintf(stderr, "biblioteca: sem resposta válida da placa na posição %u\n", (unsigned)pos);
+                return 1;
+            }
+            continue;
+        }
+        if (a[0] == NP_LIB_ERR_ORDER && iniciado)
+        {
+            pos = le32(&a[1]);
+            reenvios++;
+            if (++falhas == 5)
+            {
+                fprintf(stderr, "biblioteca: a placa recusa a posição %u\n", (unsigned)pos);
+                return 1;
+            }
+            continue;
+        }
+        if (a[0] != NP_LIB_OK)
+        {
+            static const char *const erros[] = {"", "pacote", "tamanho maior que a particao", "ordem",
+                                                "gravacao da flash", "imagem invalida"};
+            fprintf(stderr, "biblioteca: a placa recusou (%s)\n", a[0] < 6 ? erros[a[0]] : "?");
+            return 1;
+        }
+
+        falhas = 0;
+        if (!iniciado)
+            iniciado = true;
+        else if (pos < size)
+            pos = le32(&a[1]);
+        else
+            break;
+    }
+
+    printf("biblioteca: %u bytes em %.2f s, reenvios=%u\n", (unsigned)size, agora() - t0, reenvios);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool delta = false, loopback = false;
+    uint quadros = 200, fps = 0, janela = 2, leds = LED_COUNT;
+    const char *caminho = NULL, *biblioteca = NULL;
+    pid_t filho = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-d") == 0)
+            delta = true;
+        else if (strcmp(argv[i], "-l") == 0)
+            loopback = true;
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            quadros = (uint)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+            fps = (uint)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            janela = (uint)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            leds = (uint)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc)
+            biblioteca = argv[++i];
+        else
+            caminho = argv[i];
+    }
+    if ((!loopback && !caminho) || leds == 0 || leds > MAX_LEDS || janela == 0)
+    {
+        fprintf(stderr, "uso: np_stream_send [-d] [-n quadros] [-f fps] [-w janela] [-c leds] (-l | /dev/ttyACM0)\n"
+                        "     np_stream_send -u biblioteca.bin (-l | /dev/ttyACM0)\n");
+        return 2;
+    }
+
+    if (loopback)
+    {
+        // O modo cru vai no lado escravo antes do fork: nada passa pela disciplina de linha.
+        int m = posix_openpt(O_RDWR | O_NOCTTY);
+        if (m < 0 || grantpt(m) < 0 || unlockpt(m) < 0)
+            return perror("posix_openpt"), 1;
+        int s = open(ptsname(m), O_RDWR | O_NOCTTY);
+        if (s < 0)
+            return perror(ptsname(m)), 1;
+        modoCru(s);
+        leds = LED_COUNT;
+        filho = fork();
+        if (filho == 0)
+        {
+            close(m);
+            exit(receptor(s));
+        }
+        close(s);
+        fd = m;
+    }
+    else
+    {
+        fd = open(caminho, O_RDWR | O_NOCTTY);
+        if (fd < 0)
+            return perror(caminho), 1;
+        modoCru(fd);
+    }
+
+    if (biblioteca)
+    {
+        static uint8_t img[NP_LIB_SIZE + 1];
+        FILE *f = fopen(biblioteca, "rb");
+        if (!f)
+            return perror(biblioteca), 1;
+        size_t size = fread(img, 1, sizeof(img), f);
+        fclose(f);
+        if (size > NP_LIB_SIZE)
+        {
+            fprintf(stderr, "%s: maior que a partição (%d bytes)\n", biblioteca, NP_LIB_SIZE);
+            return 1;
+        }
+        int r = enviaBiblioteca(img, (uint32_t)size);
+        if (filho > 0)
+        {
+            int st;
+            waitpid(filho, &st, 0);
+            if (r == 0 && (!WIFEXITED(st) || WEXITSTATUS(st) != 0))
+                r = 1;
+        }
+        close(fd);
+        return r;
+    }
+
+    // Entra no modo ao vivo e espera o primeiro 'K'.
+    uint8_t cmd = NP_STREAM_CMD;
+    escreveTudo(fd, &cmd, 1);
+    for (int t = 0; t < 20 && !tem_status; t++)
+        leStatus(100);
+    if (!tem_status)
+    {
+        fprintf(stderr, "a placa não entrou no modo ao vivo\n");
+        return 1;
+    }
+
+    static uint8_t atual[3 * MAX_LEDS], anterior[3 * MAX_LEDS];
+    static uint8_t buf[6 * MAX_LEDS + 16]; // Pior caso do 'D': um trecho de 1 LED a cada 2.
+    uint32_t descartes_vistos = placa.dropped;
+    bool tem_anterior = false;
+    size_t bytes = 0;
+    uint crus = 0;
+    double t0 = agora();
+
+    for (uint q = 0; q < quadros; q++)
+    {
+        // Controle de fluxo: no máximo janela quadros ainda não exibidos nem descartados.
+        while (q - (placa.displayed + placa.dropped) >= janela)
+        {
+            if (!leStatus(1000))
+            {
+                fprintf(stderr, "quadro %u: sem resposta da placa\n", q);
+                return 1;
+            }
+        }
+        while (leStatus(0))
+            ;
+
+        desenha(atual, leds, q);
+        size_t len;
+        if (!delta || !tem_anterior || placa.dropped != descartes_vistos)
+        {
+            buf[5] = buf[6] = 0;
+            memcpy(&buf[7], atual, 3 * leds);
+            len = pacote(buf, NP_STREAM_RAW, 2 + 3 * leds);
+            descartes_vistos = placa.dropped;
+            crus++;
+        }
+        else
+            len = pacote(buf, NP_STREAM_DELTA, codificaDelta(&buf[5], atual, anterior, leds));
+        len += pacote(&buf[len], NP_STREAM_SYNC, 0);
+        escreveTudo(fd, buf, len);
+        bytes += len;
+        memcpy(anterior, atual, 3 * leds);
+        tem_anterior = true;
+
+        if (fps)
+        {
+            double alvo = t0 + (double)(q + 1) / fps, espera = alvo - agora();
+            if (espera > 0)
+                poll(NULL, 0, (int)(espera * 1000));
+        }
+    }
+
+    // Espera o último quadro e sai do modo ao vivo.
+    while (placa.displayed + placa.dropped < quadros && leStatus(1000))
+        ;
+    double dt = agora() - t0;
+    escreveTudo(fd, buf, pacote(buf, NP_STREAM_EXIT, 0));
+
+    printf("quadros=%u crus=%u bytes=%zu bytes_por_quadro=%.1f recebidos=%u exibidos=%u descartados=%u "
+           "tempo=%.3fs fps=%.1f\n",
+           quadros, crus, bytes, quadros ? (double)bytes / quadros : 0.0, (unsigned)placa.received,
+           (unsigned)placa.displayed, (unsigned)placa.dropped, dt, dt > 0 ? placa.displayed / dt : 0.0);
+
+    if (filho > 0)
+    {
+        int st;
+        waitpid(filho, &st, 0);
+    }
+    close(fd);
+    return placa.displayed + placa.dropped == quadros ? 0 : 1;
+}
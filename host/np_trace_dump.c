@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <string.h>
+#include "np_trace.h"
+
+// Decodifica a telemetria binária de np_trace.c. A serial também carrega o texto
+// de printf, então tudo que não forma um pacote válido é repassado como texto.
+// Uso: np_trace_dump [-q] [-s] [arquivo|/dev/ttyACM0]
+//   -q  não lista os eventos   -s  resumo por tipo no final
+
+static const char *const nomes[] = {
+    [NP_EV_FRAME_START] = "FRAME_START",
+    [NP_EV_FRAME_END] = "FRAME_END",
+    [NP_EV_WRITE] = "WRITE",
+    [NP_EV_STALL] = "STALL",
+    [NP_EV_KEY] = "KEY",
+    [NP_EV_CMD] = "CMD",
+    [NP_EV_TASK] = "TASK",
+    [NP_EV_RING_DROP] = "RING_DROP",
+    [NP_EV_RING_LATE] = "RING_LATE",
+    [NP_EV_DROPPED] = "DROPPED",
+    [NP_EV_FRAME_SKIP] = "FRAME_SKIP",
+    [NP_EV_MARK] = "MARK",
+};
+#define NUM_TIPOS (NP_EV_MARK + 1)
+
+typedef struct
+{
+    unsigned long n;
+    unsigned min, max;
+    unsigned long long soma;
+} resumo_t;
+
+static resumo_t resumo[NUM_TIPOS];
+static resumo_t periodo; // Entre FRAME_START seguidos.
+static uint32_t ultimo_quadro[2];
+static bool tem_quadro[2];
+static unsigned long pacotes, invalidos;
+static bool quieto;
+
+static void acumula(resumo_t *r, unsigned v)
+{
+    if (r->n == 0 || v < r->min)
+        r->min = v;
+    if (r->n == 0 || v > r->max)
+        r->max = v;
+    r->soma += v;
+    r->n++;
+}
+
+static void evento(const uint8_t *p)
+{
+    uint32_t t = p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+    unsigned tipo = p[4] & 0x7F, core = p[4] >> 7, a = p[5], b = p[6] | p[7] << 8;
+    const char *nome = tipo < NUM_TIPOS && nomes[tipo] ? nomes[tipo] : "?";
+
+    if (tipo < NUM_TIPOS)
+        acumula(&resumo[tipo], b);
+    if (quieto)
+    {
+        if (tipo == NP_EV_FRAME_START)
+        {
+            if (tem_quadro[core])
+                acumula(&periodo, t - ultimo_quadro[core]);
+            ultimo_quadro[core] = t;
+            tem_quadro[core] = true;
+        }
+        return;
+    }
+
+    printf("%10u us c%u %-11s ", (unsigned)t, core, nome);
+    switch (tipo)
+    {
+    case NP_EV_FRAME_START:
+        printf("quadro=%u", b);
+        if (tem_quadro[core])
+        {
+            printf(" periodo=%uus", (unsigned)(t - ultimo_quadro[core]));
+            acumula(&periodo, t - ultimo_quadro[core]);
+        }
+        ultimo_quadro[core] = t;
+        tem_quadro[core] = true;
+        break;
+    case NP_EV_FRAME_END:
+        printf("leds=%u", b);
+        break;
+    case NP_EV_WRITE:
+    case NP_EV_STALL:
+        printf("%uus", b);
+        break;
+    case NP_EV_KEY:
+        printf("'%c' %s", a, b == 0 ? "desce" : "sobe");
+        break;
+    case NP_EV_CMD:
+        printf("'%c'", a);
+        break;
+    case NP_EV_TASK:
+        printf("tarefa=%u %uus", a, b);
+        break;
+    default:
+        printf("a=%u b=%u", a, b);
+        break;
+    }
+    printf("\n");
+}
+
+/**
+ * Processa buf[0..len); retorna quantos bytes consumiu (o resto pode ser um pacote incompleto).
+ */
+static size_t processa(const uint8_t *buf, size_t len, bool fim)
+{
+    size_t i = 0;
+
+    while (i < len)
+    {
+        if (buf[i] != NP_TRACE_SYNC0)
+        {
+            if (!quieto)
+                putchar(buf[i]);
+            i++;
+            continue;
+        }
+        if (len - i < 3 || (buf[i + 1] == NP_TRACE_SYNC1 && len - i < 4u + 8u * buf[i + 2]))
+        {
+            if (!fim)
+                return i; // Espera o resto do pacote.
+        }
+        else if (buf[i + 1] == NP_TRACE_SYNC1 && buf[i + 2] > 0 && buf[i + 2] <= NP_TRACE_PACKET_EVENTS)
+        {
+            unsigned n = buf[i + 2];
+            uint8_t sum = 0;
+            for (unsigned k = 0; k < 8 * n; k++)
+                sum ^= buf[i + 3 + k];
+            if (sum == buf[i + 3 + 8 * n])
+            {
+                for (unsigned k = 0; k < n; k++)
+                    evento(&buf[i + 3 + 8 * k]);
+                pacotes++;
+                i += 4 + 8 * n;
+                continue;
+            }
+            invalidos++;
+        }
+        if (!quieto)
+            putchar(buf[i]);
+        i++;
+    }
+    return i;
+}
+
+int main(int argc, char **argv)
+{
+    bool mostra_resumo = false;
+    FILE *f = stdin;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-q") == 0)
+            quieto = true;
+        else if (strcmp(argv[i], "-s") == 0)
+            mostra_resumo = true;
+        else if (!(f = fopen(argv[i], "rb")))
+            return perror(argv[i]), 1;
+    }
+
+    static uint8_t buf[4096];
+    size_t len = 0, lidos;
+    while ((lidos = fread(buf + len, 1, sizeof(buf) - len, f)) > 0)
+    {
+        len += lidos;
+        size_t usados = processa(buf, len, false);
+        memmove(buf, buf + usados, len - usados);
+        len -= usados;
+        fflush(stdout);
+    }
+    processa(buf, len, true);
+
+    if (mostra_resumo)
+    {
+        printf("pacotes=%lu invalidos=%lu\n", pacotes, invalidos);
+        for (unsigned t = 1; t < NUM_TIPOS; t++)
+        {
+            const resumo_t *r = &resumo[t];
+            if (r->n)
+                printf("%s n=%lu b_min=%u b_med=%.1f b_max=%u\n", nomes[t], r->n, r->min, (double)r->soma / r->n, r->max);
+        }
+        if (periodo.n)
+            printf("periodo_quadro_us min=%u med=%.1f max=%u\n", periodo.min, (double)periodo.soma / periodo.n, periodo.max);
+    }
+    return 0;
+}
@@ -0,0 +1,434 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pio_asm.h"
+
+#define MAX_SYMBOLS 64
+
+typedef struct
+{
+    char name[32];
+    int value;
+} symbol_t;
+
+typedef struct
+{
+    symbol_t sym[MAX_SYMBOLS];
+    int count;
+} symtab_t;
+
+static const char *path_atual;
+static int linha_atual;
+
+static void asm_error(const char *msg, const char *tok)
+{
+    fprintf(stderr, "%s:%d: %s%s%s\n", path_atual, linha_atual, msg, tok ? ": " : "", tok ? tok : "");
+}
+
+static char *trim(char *s)
+{
+    while (isspace((unsigned char)*s))
+        s++;
+    char *e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1]))
+        *--e = 0;
+    return s;
+}
+
+static bool sym_get(const symtab_t *t, const char *name, int *value)
+{
+    for (int i = 0; i < t->count; i++)
+    {
+        if (strcmp(t->sym[i].name, name) == 0)
+        {
+            *value = t->sym[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sym_set(symtab_t *t, const char *name, int value)
+{
+    if (t->count < MAX_SYMBOLS)
+    {
+        snprintf(t->sym[t->count].name, sizeof(t->sym[0].name), "%s", name);
+        t->sym[t->count++].value = value;
+    }
+}
+
+/**
+ * Valor numérico (decimal, 0x, 0b) ou símbolo (.define / label).
+ */
+static bool parse_value(const symtab_t *t, const char *s, int *value)
+{
+    char *end;
+
+    s = s[0] == '(' ? s + 1 : s;
+    if (s[0] == '0' && (s[1] == 'b' || s[1] == 'B'))
+        *value = (int)strtol(s + 2, &end, 2);
+    else if (isdigit((unsigned char)s[0]) || s[0] == '-')
+        *value = (int)strtol(s, &end, 0);
+    else
+        return sym_get(t, s, value);
+    return *end == 0 || *end == ')';
+}
+
+static int lookup(const char *const *names, int n, const char *s)
+{
+    for (int i = 0; i < n; i++)
+        if (names[i] && strcmp(names[i], s) == 0)
+            return i;
+    return -1;
+}
+
+static const char *const jmp_cond[] = {"", "!x", "x--", "!y", "y--", "x!=y", "pin", "!osre"};
+static const char *const in_src[] = {"pins", "x", "y", "null", NULL, NULL, "isr", "osr"};
+static const char *const out_dst[] = {"pins", "x", "y", "null", "pindirs", "pc", "isr", "exec"};
+static const char *const mov_dst[] = {"pins", "x", "y", NULL, "exec", "pc", "isr", "osr"};
+static const char *const mov_src[] = {"pins", "x", "y", "null", NULL, "status", "isr", "osr"};
+static const char *const set_dst[] = {"pins", "x", "y", NULL, "pindirs", NULL, NULL, NULL};
+
+/**
+ * Separa os argumentos da instrução (por vírgulas e espaços) em tokens.
+ */
+static int split_args(char *s, char *argv[], int max)
+{
+    int n = 0;
+
+    for (char *tok = strtok(s, ", \t"); tok && n < max; tok = strtok(NULL, ", \t"))
+        argv[n++] = tok;
+    return n;
+}
+
+/**
+ * Monta uma instrução (sem side-set/delay, que são tratados pelo chamador).
+ */
+static bool assemble(const symtab_t *t, char *text, uint16_t *out)
+{
+    char *argv[8];
+    int argc = split_args(text, argv, 8);
+    int v, i;
+
+    if (argc == 0)
+        return false;
+
+    const char *op = argv[0];
+    if (strcmp(op, "nop") == 0)
+    {
+        *out = 0xA042; // mov y, y
+        return true;
+    }
+    if (strcmp(op, "jmp") == 0)
+    {
+        int cond = 0;
+        if (argc == 3 && (cond = lookup(jmp_cond, 8, argv[1])) <= 0)
+            return asm_error("condição de jmp inválida", argv[1]), false;
+        if (argc < 2 || !parse_value(t, argv[argc - 1], &v))
+            return asm_error("destino de jmp inválido", argc > 1 ? argv[argc - 1] : NULL), false;
+        *out = (uint16_t)(0x0000 | cond << 5 | (v & 31));
+        return true;
+    }
+    if (strcmp(op, "wait") == 0 && argc >= 4)
+    {
+        int pol, idx;
+        int src = lookup((const char *const[]){"gpio", "pin", "irq"}, 3, argv[2]);
+        if (src < 0 || !parse_value(t, argv[1], &pol) || !parse_value(t, argv[3], &idx))
+            return asm_error("wait inválido", NULL), false;
+        if (argc >= 5 && strcmp(argv[4], "rel") == 0)
+            idx |= 0x10;
+        *out = (uint16_t)(0x2000 | (pol & 1) << 7 | src << 5 | (idx & 31));
+        return true;
+    }
+    if ((strcmp(op, "in") == 0 || strcmp(op, "out") == 0) && argc == 3)
+    {
+        bool is_in = op[0] == 'i';
+        i = lookup(is_in ? in_src : out_dst, 8, argv[1]);
+        if (i < 0 || !parse_value(t, argv[2], &v) || v < 1 || v > 32)
+            return asm_error("argumentos inválidos", op), false;
+        *out = (uint16_t)((is_in ? 0x4000 : 0x6000) | i << 5 | (v & 31));
+        return true;
+    }
+    if (strcmp(op, "push") == 0 || strcmp(op, "pull") == 0)
+    {
+        bool is_pull = op[1] == 'u' && op[2] == 'l';
+        uint16_t w = is_pull ? 0x8080 : 0x8000;
+        bool block = true;
+        for (i = 1; i < argc; i++)
+        {
+            if (strcmp(argv[i], "iffull") == 0 || strcmp(argv[i], "ifempty") == 0)
+                w |= 0x40;
+            else if (strcmp(argv[i], "noblock") == 0)
+                block = false;
+            else if (strcmp(argv[i], "block") != 0)
+                return asm_error("opção inválida", argv[i]), false;
+        }
+        *out = w | (block ? 0x20 : 0);
+        return true;
+    }
+    if (strcmp(op, "mov") == 0 && argc == 3)
+    {
+        const char *src = argv[2];
+        int opr = 0;
+        if (src[0] == '!' || src[0] == '~')
+            opr = 1, src++;
+        else if (src[0] == ':' && src[1] == ':')
+            opr = 2, src += 2;
+        int d = lookup(mov_dst, 8, argv[1]);
+        int s = lookup(mov_src, 8, src);
+        if (d < 0 || s < 0)
+            return asm_error("mov inválido", NULL), false;
+        *out = (uint16_t)(0xA000 | d << 5 | opr << 3 | s);
+        return true;
+    }
+    if (strcmp(op, "irq") == 0 && argc >= 2)
+    {
+        int mode = 0; // 0: set, 1: wait, 2: clear
+        int a = 1;
+        if (strcmp(argv[1], "set") == 0 || strcmp(argv[1], "nowait") == 0)
+            a++;
+        else if (strcmp(argv[1], "wait") == 0)
+            mode = 1, a++;
+        else if (strcmp(argv[1], "clear") == 0)
+            mode = 2, a++;
+        if (a >= argc || !parse_value(t, argv[a], &v))
+            return asm_error("irq inválido", NULL), false;
+        if (a + 1 < argc && strcmp(argv[a + 1], "rel") == 0)
+            v |= 0x10;
+        *out = (uint16_t)(0xC000 | (mode == 2) << 6 | (mode == 1) << 5 | (v & 31));
+        return true;
+    }
+    if (strcmp(op, "set") == 0 && argc == 3)
+    {
+        i = lookup(set_dst, 8, argv[1]);
+        if (i < 0 || !parse_value(t, argv[2], &v))
+            return asm_error("set inválido", NULL), false;
+        *out = (uint16_t)(0xE000 | i << 5 | (v & 31));
+        return true;
+    }
+    return asm_error("instrução desconhecida", op), false;
+}
+
+/**
+ * Extrai "side N" e "[D]" do fim da linha e monta o campo de delay/side-set.
+ */
+static bool parse_modifiers(const symtab_t *t, const pio_asm_program_t *p, char *s, uint16_t *field)
+{
+    int side = -1, delay = 0;
+    char *br = strchr(s, '[');
+    if (br)
+    {
+        *br = 0;
+        if (!parse_value(t, trim(strtok(br + 1, "]")), &delay))
+            return asm_error("delay inválido", NULL), false;
+    }
+    char *sd = strstr(s, " side ");
+    if (!sd)
+        sd = strstr(s, "\tside ");
+    if (sd)
+    {
+        *sd = 0;
+        if (!parse_value(t, trim(sd + 6), &side))
+            return asm_error("side-set inválido", NULL), false;
+    }
+
+    int data_bits = p->sideset_bits - (p->sideset_opt ? 1 : 0);
+    int delay_bits = 5 - p->sideset_bits;
+    if (delay >= (1 << delay_bits))
+        return asm_error("delay grande demais para o side-set", NULL), false;
+    if (side < 0 && p->sideset_bits && !p->sideset_opt)
+        return asm_error("side-set obrigatório", NULL), false;
+
+    uint16_t f = (uint16_t)delay;
+    if (side >= 0)
+    {
+        if (p->sideset_bits == 0 || side >= (1 << data_bits))
+            return asm_error("side-set inválido", NULL), false;
+        f |= (uint16_t)((side | (p->sideset_opt ? 1 << data_bits : 0)) << delay_bits);
+    }
+    *field = (uint16_t)(f << 8);
+    return true;
+}
+
+/**
+ * Monta o programa name do arquivo path. Retorna false (com mensagem em stderr) em caso de erro.
+ */
+bool pio_asm_load(const char *path, const char *name, pio_asm_program_t *out)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    symtab_t globals = {0}, t;
+
+    if (!f)
+        return perror(path), false;
+    path_atual = path;
+
+    // Duas passagens: a primeira coleta labels, a segunda monta.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        bool in_prog = false, in_sdk = false, found = false;
+        int pc = 0;
+
+        rewind(f);
+        linha_atual = 0;
+        memset(out, 0, sizeof(*out));
+        out->wrap = 0xFF;
+
+        while (fgets(line, sizeof(line), f))
+        {
+            linha_atual++;
+            if (in_sdk)
+            {
+                if (strncmp(line, "%}", 2) == 0)
+                    in_sdk = false;
+                else if (in_prog && strlen(out->c_sdk) + strlen(line) < sizeof(out->c_sdk))
+                    strcat(out->c_sdk, line);
+                continue;
+            }
+            if (line[0] == '%')
+            {
+                in_sdk = true;
+                continue;
+            }
+
+            char *c = strpbrk(line, ";");
+            if (c)
+                *c = 0;
+            if ((c = strstr(line, "//")) != NULL)
+                *c = 0;
+            char *s = trim(line);
+            if (*s == 0)
+                continue;
+
+            if (strncmp(s, ".program", 8) == 0)
+            {
+                in_prog = strcmp(trim(s + 8), name) == 0;
+                if (in_prog)
+                {
+                    found = true;
+                    snprintf(out->name, sizeof(out->name), "%s", name);
+                    if (pass == 0)
+                        t = globals;
+                }
+                continue;
+            }
+            if (strncmp(s, ".define", 7) == 0)
+            {
+                char *argv[4];
+                int v;
+                int argc = split_args(s + 7, argv, 4);
+                int k = argc == 3 ? 1 : 0; // ".define public NOME valor"
+                if (pass == 0 && argc >= 2 && parse_value(in_prog ? &t : &globals, argv[k + 1], &v))
+                    sym_set(in_prog ? &t : &globals, argv[k], v);
+                continue;
+            }
+            if (!in_prog)
+                continue;
+
+            if (strncmp(s, ".side_set", 9) == 0)
+            {
+                char *argv[4];
+                int argc = split_args(s + 9, argv, 4);
+                out->sideset_opt = argc > 1 && strcmp(argv[1], "opt") == 0;
+                out->sideset_bits = (uint8_t)(atoi(argv[0]) + (out->sideset_opt ? 1 : 0));
+                continue;
+            }
+            if (strcmp(s, ".wrap_target") == 0)
+            {
+                out->wrap_target = (uint8_t)pc;
+                continue;
+            }
+            if (strcmp(s, ".wrap") == 0)
+            {
+                out->wrap = (uint8_t)(pc - 1);
+                continue;
+            }
+            if (s[0] == '.')
+                continue; // .origin, .lang_opt etc. não afetam a execução.
+
+            if (strncmp(s, "public ", 7) == 0)
+                s = trim(s + 7);
+            size_t len = strlen(s);
+            if (s[len - 1] == ':' && !strpbrk(s, " \t"))
+            {
+                s[len - 1] = 0;
+                if (pass == 0)
+                    sym_set(&t, s, pc);
+                continue;
+            }
+
+            if (pc >= PIO_ASM_MAX_INSTR)
+            {
+                asm_error("programa longo demais", NULL);
+                fclose(f);
+                return false;
+            }
+            if (pass == 1)
+            {
+                uint16_t field, instr;
+                char buf[256];
+                snprintf(buf, sizeof(buf), " %s", s);
+                if (!parse_modifiers(&t, out, buf, &field) || !assemble(&t, buf, &instr))
+                {
+                    fclose(f);
+                    return false;
+                }
+                out->instr[pc] = instr | field;
+            }
+            pc++;
+        }
+
+        if (!found)
+        {
+            fprintf(stderr, "%s: programa '%s' não encontrado\n", path, name);
+            fclose(f);
+            return false;
+        }
+        out->length = (uint8_t)pc;
+        if (out->wrap == 0xFF)
+            out->wrap = (uint8_t)(pc - 1);
+    }
+
+    fclose(f);
+    return true;
+}
+
+/**
+ * Texto de uma instrução, para rastreamento.
+ */
+void pio_asm_disassemble(const pio_asm_program_t *p, uint16_t instr, char *buf, int size)
+{
+    static const char *const ops[] = {"jmp", "wait", "in", "out", "push/pull", "mov", "irq", "set"};
+    int delay_bits = 5 - p->sideset_bits;
+    int field = (instr >> 8) & 31;
+    int arg = instr & 0xFF;
+
+    int n = snprintf(buf, size, "%-5s", ops[instr >> 13]);
+    switch (instr >> 13)
+    {
+    case 0:
+        n += snprintf(buf + n, size - n, " %s%s%d", jmp_cond[arg >> 5], arg >> 5 ? ", " : "", arg & 31);
+        break;
+    case 2:
+        n += snprintf(buf + n, size - n, " %s, %d", in_src[arg >> 5] ? in_src[arg >> 5] : "?", (arg & 31) ? arg & 31 : 32);
+        break;
+    case 3:
+        n += snprintf(buf + n, size - n, " %s, %d", out_dst[arg >> 5], (arg & 31) ? arg & 31 : 32);
+        break;
+    case 5:
+        n += snprintf(buf + n, size - n, " %s, %s%s", mov_dst[arg >> 5] ? mov_dst[arg >> 5] : "?",
+                      (const char *const[]){"", "!", "::", "?"}[(arg >> 3) & 3], mov_src[arg & 7] ? mov_src[arg & 7] : "?");
+        break;
+    case 7:
+        n += snprintf(buf + n, size - n, " %s, %d", set_dst[arg >> 5] ? set_dst[arg >> 5] : "?", arg & 31);
+        break;
+    default:
+        n += snprintf(buf + n, size - n, " 0x%02x", arg);
+        break;
+    }
+    if (p->sideset_bits)
+        n += snprintf(buf + n, size - n, " side %d", (field >> delay_bits) & ((1 << (p->sideset_bits - p->sideset_opt)) - 1));
+    if (field & ((1 << delay_bits) - 1))
+        snprintf(buf + n, size - n, " [%d]", field & ((1 << delay_bits) - 1));
+}
@@ -0,0 +1,29 @@
+#ifndef PIO_ASM_H
+#define PIO_ASM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Montador mínimo de arquivos .pio para as ferramentas de host (o pioasm do
+// SDK não está disponível aqui). Cobre o que os programas deste repositório
+// usam: todas as instruções, labels, side-set (com opt), delays, .wrap_target/.wrap
+// e .define. O bloco "% c-sdk" do programa é guardado como texto.
+
+#define PIO_ASM_MAX_INSTR 32
+
+typedef struct
+{
+    char name[32];
+    uint16_t instr[PIO_ASM_MAX_INSTR];
+    uint8_t length;
+    uint8_t wrap_target;
+    uint8_t wrap;
+    uint8_t sideset_bits; // Bits do campo de delay usados pelo side-set (inclui o bit de opt).
+    bool sideset_opt;
+    char c_sdk[4096];     // Conteúdo do bloco "% c-sdk { ... %}".
+} pio_asm_program_t;
+
+bool pio_asm_load(const char *path, const char *name, pio_asm_program_t *out);
+void pio_asm_disassemble(const pio_asm_program_t *p, uint16_t instr, char *buf, int size);
+
+#endif
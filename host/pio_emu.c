@@ -0,0 +1,321 @@
+#include <string.h>
+#include "pio_emu.h"
+
+/**
+ * Estado após pio_sm_init: OSR vazio (autopull recarrega na primeira instrução out),
+ * pc no início do programa e divisor 1.
+ */
+void pio_emu_init(pio_emu_sm_t *sm, const pio_asm_program_t *prog)
+{
+    memset(sm, 0, sizeof(*sm));
+    sm->prog = prog;
+    sm->out_count = 32;
+    sm->set_count = 5;
+    sm->out_shift_right = sm->in_shift_right = true;
+    sm->pull_threshold = sm->push_threshold = 32;
+    sm->osr_count = 32;
+    sm->fifo_depth = 4;
+    sm->clkdiv_int = 1;
+}
+
+/**
+ * Mesmo arredondamento de sm_config_set_clkdiv: parte inteira e fração em 1/256.
+ */
+void pio_emu_set_clkdiv(pio_emu_sm_t *sm, float div)
+{
+    sm->clkdiv_int = (uint16_t)div;
+    sm->clkdiv_frac = (uint8_t)((div - sm->clkdiv_int) * 256);
+}
+
+bool pio_emu_tx_push(pio_emu_sm_t *sm, uint32_t word)
+{
+    if (sm->tx_count >= sm->fifo_depth)
+        return false;
+    sm->tx[(sm->tx_head + sm->tx_count++) % PIO_EMU_FIFO_DEPTH] = word;
+    return true;
+}
+
+static bool tx_pop(pio_emu_sm_t *sm, uint32_t *word)
+{
+    if (sm->tx_count == 0)
+        return false;
+    *word = sm->tx[sm->tx_head];
+    sm->tx_head = (sm->tx_head + 1) % PIO_EMU_FIFO_DEPTH;
+    sm->tx_count--;
+    return true;
+}
+
+static bool rx_push(pio_emu_sm_t *sm, uint32_t word)
+{
+    if (sm->rx_count >= sm->fifo_depth)
+        return false;
+    sm->rx[(sm->rx_head + sm->rx_count++) % PIO_EMU_FIFO_DEPTH] = word;
+    return true;
+}
+
+bool pio_emu_rx_pop(pio_emu_sm_t *sm, uint32_t *word)
+{
+    if (sm->rx_count == 0)
+        return false;
+    *word = sm->rx[sm->rx_head];
+    sm->rx_head = (sm->rx_head + 1) % PIO_EMU_FIFO_DEPTH;
+    sm->rx_count--;
+    return true;
+}
+
+/**
+ * Tempo decorrido em ciclos de clk_sys (o divisor fracionário dá a média exata).
+ */
+uint64_t pio_emu_sys_clocks(const pio_emu_sm_t *sm)
+{
+    return sm->cycles * ((uint64_t)sm->clkdiv_int * 256 + sm->clkdiv_frac) / 256;
+}
+
+static uint32_t mask(unsigned n)
+{
+    return n >= 32 ? 0xFFFFFFFFu : (1u << n) - 1;
+}
+
+static void write_pins(uint32_t *reg, unsigned base, unsigned count, uint32_t value)
+{
+    uint32_t m = mask(count);
+    uint32_t rot = (m << base) | (base ? m >> (32 - base) : 0);
+    uint32_t v = (value & m) << base | (base ? (value & m) >> (32 - base) : 0);
+    *reg = (*reg & ~rot) | v;
+}
+
+static uint32_t read_pins(const pio_emu_sm_t *sm)
+{
+    unsigned b = sm->in_base;
+    return b ? sm->gpio_in >> b | sm->gpio_in << (32 - b) : sm->gpio_in;
+}
+
+static uint32_t bit_reverse(uint32_t v)
+{
+    uint32_t r = 0;
+    for (int i = 0; i < 32; i++, v >>= 1)
+        r = r << 1 | (v & 1);
+    return r;
+}
+
+/**
+ * Retira n bits do OSR na direção configurada.
+ */
+static uint32_t osr_shift(pio_emu_sm_t *sm, unsigned n)
+{
+    uint32_t data;
+    if (sm->out_shift_right)
+    {
+        data = sm->osr & mask(n);
+        sm->osr = n >= 32 ? 0 : sm->osr >> n;
+    }
+    else
+    {
+        data = n >= 32 ? sm->osr : sm->osr >> (32 - n);
+        sm->osr = n >= 32 ? 0 : sm->osr << n;
+    }
+    sm->osr_count = (uint8_t)(sm->osr_count + n > 32 ? 32 : sm->osr_count + n);
+    return data;
+}
+
+static void isr_shift(pio_emu_sm_t *sm, uint32_t data, unsigned n)
+{
+    data &= mask(n);
+    if (sm->in_shift_right)
+        sm->isr = n >= 32 ? data : (sm->isr >> n) | (data << (32 - n));
+    else
+        sm->isr = n >= 32 ? data : (sm->isr << n) | data;
+    sm->isr_count = (uint8_t)(sm->isr_count + n > 32 ? 32 : sm->isr_count + n);
+}
+
+static uint32_t mov_source(pio_emu_sm_t *sm, unsigned src)
+{
+    switch (src)
+    {
+    case 0:
+        return read_pins(sm);
+    case 1:
+        return sm->x;
+    case 2:
+        return sm->y;
+    case 5:
+        return sm->tx_count == 0 ? 0xFFFFFFFFu : 0; // STATUS_TX_LESSTHAN 1
+    case 6:
+        return sm->isr;
+    case 7:
+        return sm->osr;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Executa um ciclo da máquina. Instruções que esperam (FIFO vazia/cheia, wait)
+ * repetem no próximo ciclo com o side-set já aplicado, como no hardware.
+ */
+void pio_emu_step(pio_emu_sm_t *sm)
+{
+    const pio_asm_program_t *p = sm->prog;
+
+    sm->cycles++;
+    if (sm->delay_left)
+    {
+        sm->delay_left--;
+        return;
+    }
+
+    uint16_t instr = p->instr[sm->pc];
+    unsigned field = (instr >> 8) & 31;
+    unsigned delay_bits = 5 - p->sideset_bits;
+    unsigned arg = instr & 0xFF;
+    unsigned n = arg & 31 ? arg & 31 : 32;
+    int next = -1;
+
+    // Side-set vale desde o primeiro ciclo da instrução, mesmo parada.
+    if (p->sideset_bits)
+    {
+        unsigned data_bits = p->sideset_bits - p->sideset_opt;
+        unsigned side = field >> delay_bits;
+        if (!p->sideset_opt || (side >> data_bits))
+            write_pins(&sm->pins, sm->sideset_base, data_bits, side);
+    }
+
+    sm->stalled = false;
+    switch (instr >> 13)
+    {
+    case 0: // jmp
+    {
+        bool take;
+        switch (arg >> 5)
+        {
+        case 1: take = sm->x == 0; break;
+        case 2: take = sm->x-- != 0; break;
+        case 3: take = sm->y == 0; break;
+        case 4: take = sm->y-- != 0; break;
+        case 5: take = sm->x != sm->y; break;
+        case 6: take = (sm->gpio_in >> sm->jmp_pin) & 1; break;
+        case 7: take = sm->osr_count < sm->pull_threshold; break;
+        default: take = true; break;
+        }
+        if (take)
+            next = arg & 31;
+        break;
+    }
+    case 1: // wait (só gpio/pin; irq é tratado como satisfeito)
+    {
+        unsigned src = (arg >> 5) & 3;
+        unsigned pin = src == 0 ? (arg & 31) : src == 1 ? (sm->in_base + (arg & 31)) % 32 : 0;
+        if (src < 2 && ((sm->gpio_in >> pin) & 1) != (arg >> 7))
+            sm->stalled = true;
+        break;
+    }
+    case 2: // in
+        if (sm->autopush && sm->isr_count >= sm->push_threshold)
+        {
+            if (!rx_push(sm, sm->isr))
+            {
+                sm->stalled = true;
+                break;
+            }
+            sm->isr = 0;
+            sm->isr_count = 0;
+        }
+        isr_shift(sm, mov_source(sm, arg >> 5), n);
+        break;
+    case 3: // out
+    {
+        if (sm->autopull && sm->osr_count >= sm->pull_threshold)
+        {
+            if (!tx_pop(sm, &sm->osr))
+            {
+                sm->stalled = true;
+                break;
+            }
+            sm->osr_count = 0;
+        }
+        uint32_t data = osr_shift(sm, n);
+        switch (arg >> 5)
+        {
+        case 0: write_pins(&sm->pins, sm->out_base, (n < sm->out_count ? n : sm->out_count), data); break;
+        case 1: sm->x = data; break;
+        case 2: sm->y = data; break;
+        case 4: write_pins(&sm->pindirs, sm->out_base, (n < sm->out_count ? n : sm->out_count), data); break;
+        case 5: next = data & 31; break;
+        case 6: sm->isr = data; sm->isr_count = (uint8_t)n; break;
+        default: break;
+        }
+        break;
+    }
+    case 4: // push / pull
+        if (arg & 0x80)
+        {
+            if ((arg & 0x40) && sm->osr_count < sm->pull_threshold)
+                break;
+            if (!tx_pop(sm, &sm->osr))
+            {
+                if (arg & 0x20)
+                {
+                    sm->stalled = true;
+                    break;
+                }
+                sm->osr = sm->x;
+            }
+            sm->osr_count = 0;
+        }
+        else
+        {
+            if ((arg & 0x40) && sm->isr_count < sm->push_threshold)
+                break;
+            if (!rx_push(sm, sm->isr) && (arg & 0x20))
+            {
+                sm->stalled = true;
+                break;
+            }
+            sm->isr = 0;
+            sm->isr_count = 0;
+        }
+        break;
+    case 5: // mov
+    {
+        uint32_t v = mov_source(sm, arg & 7);
+        if (((arg >> 3) & 3) == 1)
+            v = ~v;
+        else if (((arg >> 3) & 3) == 2)
+            v = bit_reverse(v);
+        switch (arg >> 5)
+        {
+        case 0: write_pins(&sm->pins, sm->out_base, sm->out_count, v); break;
+        case 1: sm->x = v; break;
+        case 2: sm->y = v; break;
+        case 5: next = v & 31; break;
+        case 6: sm->isr = v; sm->isr_count = 0; break;
+        case 7: sm->osr = v; sm->osr_count = 0; break;
+        default: break;
+        }
+        break;
+    }
+    case 6: // irq: sem outras máquinas para sincronizar
+        break;
+    case 7: // set
+        switch (arg >> 5)
+        {
+        case 0: write_pins(&sm->pins, sm->set_base, sm->set_count, arg & 31); break;
+        case 1: sm->x = arg & 31; break;
+        case 2: sm->y = arg & 31; break;
+        case 4: write_pins(&sm->pindirs, sm->set_base, sm->set_count, arg & 31); break;
+        default: break;
+        }
+        break;
+    }
+
+    if (sm->stalled)
+        return;
+
+    sm->delay_left = (uint8_t)(field & mask(delay_bits));
+    if (next >= 0)
+        sm->pc = (uint8_t)next;
+    else if (sm->pc == p->wrap)
+        sm->pc = p->wrap_target;
+    else
+        sm->pc++;
+}
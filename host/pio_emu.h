@@ -0,0 +1,51 @@
+#ifndef PIO_EMU_H
+#define PIO_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pio_asm.h"
+
+// Emulação ciclo a ciclo de uma máquina de estados PIO do RP2040, para as
+// ferramentas de host. A configuração espelha sm_config_* do SDK; os pinos
+// são um vetor de 32 bits (GPIO 0..31) e o tempo é contado em ciclos da máquina.
+
+#define PIO_EMU_FIFO_DEPTH 8 // Com PIO_FIFO_JOIN_TX/RX; sem junção use 4.
+
+typedef struct
+{
+    // Programa e configuração (preencha depois de pio_emu_init).
+    const pio_asm_program_t *prog;
+    uint8_t sideset_base;
+    uint8_t out_base, out_count;
+    uint8_t set_base, set_count;
+    uint8_t in_base;
+    uint8_t jmp_pin;
+    bool out_shift_right, autopull;
+    uint8_t pull_threshold;
+    bool in_shift_right, autopush;
+    uint8_t push_threshold;
+    uint8_t fifo_depth;
+    uint16_t clkdiv_int;
+    uint8_t clkdiv_frac;
+
+    // Estado.
+    uint8_t pc;
+    uint32_t x, y, osr, isr;
+    uint8_t osr_count, isr_count; // Bits já deslocados para fora do OSR / para dentro do ISR.
+    uint8_t delay_left;
+    bool stalled;
+    uint32_t pins, pindirs;
+    uint32_t gpio_in;             // Nível das entradas lido por in/wait/jmp pin.
+    uint32_t tx[PIO_EMU_FIFO_DEPTH], rx[PIO_EMU_FIFO_DEPTH];
+    uint8_t tx_head, tx_count, rx_head, rx_count;
+    uint64_t cycles;
+} pio_emu_sm_t;
+
+void pio_emu_init(pio_emu_sm_t *sm, const pio_asm_program_t *prog);
+void pio_emu_set_clkdiv(pio_emu_sm_t *sm, float div);
+bool pio_emu_tx_push(pio_emu_sm_t *sm, uint32_t word);
+bool pio_emu_rx_pop(pio_emu_sm_t *sm, uint32_t *word);
+void pio_emu_step(pio_emu_sm_t *sm);
+uint64_t pio_emu_sys_clocks(const pio_emu_sm_t *sm);
+
+#endif
@@ -0,0 +1,291 @@
+#include "keypad.h"
+#include "np_trace.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#if KEYPAD_USE_PIO
+#include "hardware/pio.h"
+#include "keypad.pio.h"
+#include "keypad_decode.h"
+#endif
+
+uint _columns[4];
+uint _rows[4];
+char _matrix_values[16];
+uint all_columns_mask = 0x0;
+uint column_mask[4];
+
+#if KEYPAD_USE_PIO
+static PIO kp_pio;
+static uint kp_sm;
+static keypad_decoder_t kp_decoder;
+#else
+// Estado da varredura (só acessado pela interrupção da GPIO e pelo timer).
+static repeating_timer_t scan_timer;
+static volatile bool scanning = false;
+static uint scan_row;
+static uint16_t scan_bits;     // Teclas vistas na varredura em andamento (bit = linha * 4 + coluna).
+static uint16_t last_scan;     // Resultado da última varredura completa.
+static uint16_t stable;        // Estado aceito pelo debounce.
+static uint same_scans;
+static bool edge_pending;       // Varredura iniciada por borda, ainda sem leitura diferente.
+#endif
+static uint32_t change_seen_us; // Instante em que a mudança foi vista pela primeira vez.
+
+// Fila de eventos: produtor = interrupção (timer ou PIO), consumidor = laço principal.
+static keypad_event_t queue[KEYPAD_QUEUE_SIZE];
+static volatile uint queue_head = 0;
+static volatile uint queue_tail = 0;
+
+static volatile uint32_t latency_last_us = 0;
+static volatile uint32_t latency_max_us = 0;
+
+static void keypad_push(char key, keypad_event_type_t type, uint32_t now)
+{
+    uint next = (queue_head + 1) % KEYPAD_QUEUE_SIZE;
+    if (next == queue_tail)
+        return; // Fila cheia: o evento é perdido.
+
+    queue[queue_head].key = key;
+    queue[queue_head].type = type;
+    queue[queue_head].t_edge = change_seen_us;
+    queue[queue_head].t_event = now;
+    __dmb();
+    queue_head = next;
+    npTrace(NP_EV_KEY, (uint8_t)key, type);
+}
+
+#if KEYPAD_USE_PIO
+/**
+ * FIFO RX da PIO com dados: cada palavra é uma varredura diferente da anterior.
+ */
+static void keypad_pio_irq(void)
+{
+    keypad_change_t changes[16];
+
+    while (!pio_sm_is_rx_fifo_empty(kp_pio, kp_sm))
+    {
+        change_seen_us = time_us_32();
+        uint n = keypad_decoder_feed(&kp_decoder, pio_sm_get(kp_pio, kp_sm), _matrix_values, changes);
+        for (uint i = 0; i < n; i++)
+            keypad_push(changes[i].key, changes[i].down ? KEYPAD_KEY_DOWN : KEYPAD_KEY_UP, change_seen_us);
+    }
+
+    // Acorda o laço principal, que pode estar dormindo em __wfe.
+    __sev();
+}
+#else
+/**
+ * Acende somente a linha indicada (ou todas, com row >= 4).
+ */
+static void keypad_drive_rows(uint row)
+{
+    for (uint i = 0; i < 4; i++)
+        gpio_put(_rows[i], row >= 4 || i == row);
+}
+
+/**
+ * Fim de uma varredura completa: debounce e geração de eventos.
+ * Retorna false quando todas as teclas foram soltas e a varredura pode parar.
+ */
+static bool keypad_scan_done(uint16_t bits, uint32_t now)
+{
+    if (bits != last_scan)
+    {
+        // Primeira leitura diferente do estado aceito marca o início da mudança
+        // (se a varredura começou por uma borda, o instante da borda já foi marcado).
+        if (last_scan == stable && !edge_pending)
+            change_seen_us = now;
+        edge_pending = false;
+        last_scan = bits;
+        same_scans = 1;
+        return true;
+    }
+
+    if (same_scans < KEYPAD_DEBOUNCE_SCANS)
+        same_scans++;
+    if (same_scans < KEYPAD_DEBOUNCE_SCANS)
+        return true;
+
+    // Leitura estável.
+    edge_pending = false;
+    if (bits != stable)
+    {
+        uint16_t changed = bits ^ stable;
+        for (uint i = 0; i < 16; i++)
+        {
+            if (changed & (1u << i))
+                keypad_push(_matrix_values[i], (bits & (1u << i)) ? KEYPAD_KEY_DOWN : KEYPAD_KEY_UP, now);
+        }
+        stable = bits;
+
+        // Acorda o laço principal, que pode estar dormindo em __wfe.
+        __sev();
+    }
+    return stable != 0;
+}
+
+/**
+ * Timer da varredura: lê as colunas da linha acesa e passa para a próxima linha.
+ */
+static bool keypad_scan_tick(repeating_timer_t *rt)
+{
+    uint32_t cols = gpio_get_all() & all_columns_mask;
+    for (uint c = 0; c < 4; c++)
+    {
+        if (cols & column_mask[c])
+            scan_bits |= 1u << (scan_row * 4 + c);
+    }
+
+    if (++scan_row < 4)
+    {
+        keypad_drive_rows(scan_row);
+        return true;
+    }
+
+    bool keep = keypad_scan_done(scan_bits, time_us_32());
+    scan_row = 0;
+    scan_bits = 0;
+
+    if (keep)
+    {
+        keypad_drive_rows(0);
+        return true;
+    }
+
+    // Tudo solto: volta a esperar uma borda nas colunas com todas as linhas acesas.
+    keypad_drive_rows(4);
+    scanning = false;
+    for (uint i = 0; i < 4; i++)
+    {
+        gpio_acknowledge_irq(_columns[i], GPIO_IRQ_EDGE_RISE);
+        gpio_set_irq_enabled(_columns[i], GPIO_IRQ_EDGE_RISE, true);
+    }
+    return false;
+}
+
+/**
+ * Borda de subida em alguma coluna: inicia a varredura por timer.
+ */
+static void keypad_gpio_irq(void)
+{
+    for (uint i = 0; i < 4; i++)
+    {
+        if (gpio_get_irq_event_mask(_columns[i]) & GPIO_IRQ_EDGE_RISE)
+            gpio_acknowledge_irq(_columns[i], GPIO_IRQ_EDGE_RISE);
+        gpio_set_irq_enabled(_columns[i], GPIO_IRQ_EDGE_RISE, false);
+    }
+
+    if (scanning)
+        return;
+
+    scanning = true;
+    change_seen_us = time_us_32();
+    edge_pending = true;
+    last_scan = stable;
+    same_scans = 0;
+    scan_row = 0;
+    scan_bits = 0;
+    keypad_drive_rows(0);
+    add_repeating_timer_us(-KEYPAD_SCAN_US, keypad_scan_tick, NULL, &scan_timer);
+}
+
+#endif
+
+// inicializa o keypad
+void pico_keypad_init(uint columns[4], uint rows[4], char matrix_values[16])
+{
+
+    for (int i = 0; i < 16; i++)
+    {
+        _matrix_values[i] = matrix_values[i];
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+
+        _columns[i] = columns[i];
+        _rows[i] = rows[i];
+
+        all_columns_mask = all_columns_mask + (1 << _columns[i]);
+        column_mask[i] = 1 << _columns[i];
+    }
+
+#if KEYPAD_USE_PIO
+    uint row_base = _rows[0], col_base = _columns[0];
+    for (int i = 1; i < 4; i++)
+    {
+        row_base = MIN(row_base, _rows[i]);
+        col_base = MIN(col_base, _columns[i]);
+    }
+
+    keypad_decoder_init(&kp_decoder, _rows, _columns);
+    kp_pio = pio1; // O pio0 fica com a matriz de LEDs.
+    kp_sm = pio_claim_unused_sm(kp_pio, true);
+    uint offset = pio_add_program(kp_pio, &keypad_scan_program);
+    keypad_scan_program_init(kp_pio, kp_sm, offset, row_base, col_base, KEYPAD_PIO_SCAN_HZ);
+
+    pio_set_irq0_source_enabled(kp_pio, pis_sm0_rx_fifo_not_empty + kp_sm, true);
+    irq_set_exclusive_handler(PIO1_IRQ_0, keypad_pio_irq);
+    irq_set_enabled(PIO1_IRQ_0, true);
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        gpio_init(_columns[i]);
+        gpio_init(_rows[i]);
+
+        gpio_set_dir(_columns[i], GPIO_IN);
+        gpio_pull_down(_columns[i]); // Coluna solta lê 0, evitando teclas fantasmas.
+        gpio_set_dir(_rows[i], GPIO_OUT);
+
+        gpio_put(_rows[i], 1);
+    }
+
+    gpio_add_raw_irq_handler_masked(all_columns_mask, keypad_gpio_irq);
+    for (int i = 0; i < 4; i++)
+        gpio_set_irq_enabled(_columns[i], GPIO_IRQ_EDGE_RISE, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+#endif
+}
+
+/**
+ * Retira o próximo evento da fila sem bloquear. Retorna false se a fila estiver vazia.
+ */
+bool pico_keypad_get_event(keypad_event_t *ev)
+{
+    if (queue_tail == queue_head)
+        return false;
+
+    __dmb();
+    *ev = queue[queue_tail];
+    queue_tail = (queue_tail + 1) % KEYPAD_QUEUE_SIZE;
+
+    // Latência da borda até o consumo do evento pelo laço principal.
+    uint32_t latency = time_us_32() - ev->t_edge;
+    latency_last_us = latency;
+    if (latency > latency_max_us)
+        latency_max_us = latency;
+    return true;
+}
+
+// coleta o caracter pressionado (sem bloquear; 0 se nenhuma tecla foi apertada)
+char pico_keypad_get_key(void)
+{
+    keypad_event_t ev;
+
+    while (pico_keypad_get_event(&ev))
+    {
+        if (ev.type == KEYPAD_KEY_DOWN)
+            return ev.key;
+    }
+    return 0;
+}
+
+/**
+ * Latência (borda -> evento consumido) do último evento e a maior observada.
+ */
+void pico_keypad_get_latency(uint32_t *last_us, uint32_t *max_us)
+{
+    *last_us = latency_last_us;
+    *max_us = latency_max_us;
+}
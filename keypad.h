@@ -0,0 +1,45 @@
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include "pico/stdlib.h"
+
+// 1: varredura feita pelo programa keypad_scan (keypad.pio) numa máquina do pio1;
+//    a CPU só recebe palavras quando alguma tecla muda.
+// 0: varredura por interrupção da GPIO + timer.
+// Na PIO, linhas e colunas precisam estar em GPIOs consecutivas.
+#ifndef KEYPAD_USE_PIO
+#define KEYPAD_USE_PIO 1
+#endif
+
+// Frequência de varredura da PIO. Um período de 4ms já supera o bounce dos contatos.
+#define KEYPAD_PIO_SCAN_HZ 250
+
+// Intervalo entre duas linhas da varredura (uma varredura completa = 4 intervalos).
+#define KEYPAD_SCAN_US 1000
+
+// Varreduras iguais seguidas necessárias para aceitar uma mudança (debounce).
+#define KEYPAD_DEBOUNCE_SCANS 3
+
+// Capacidade da fila de eventos (potência de 2).
+#define KEYPAD_QUEUE_SIZE 16
+
+typedef enum
+{
+    KEYPAD_KEY_DOWN,
+    KEYPAD_KEY_UP,
+} keypad_event_type_t;
+
+typedef struct
+{
+    char key;
+    uint8_t type;      // keypad_event_type_t
+    uint32_t t_edge;   // Instante (us) em que a mudança foi vista pela primeira vez.
+    uint32_t t_event;  // Instante (us) em que o debounce confirmou a mudança.
+} keypad_event_t;
+
+void pico_keypad_init(uint columns[4], uint rows[4], char matrix_values[16]);
+bool pico_keypad_get_event(keypad_event_t *ev);
+char pico_keypad_get_key(void);
+void pico_keypad_get_latency(uint32_t *last_us, uint32_t *max_us);
+
+#endif
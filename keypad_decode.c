@@ -0,0 +1,63 @@
+#include "keypad_decode.h"
+
+static unsigned min4(const unsigned v[4])
+{
+    unsigned m = v[0];
+    for (unsigned i = 1; i < 4; i++)
+        if (v[i] < m)
+            m = v[i];
+    return m;
+}
+
+/**
+ * Calcula onde cada tecla aparece na palavra da PIO a partir dos pinos.
+ * O programa acende as linhas da menor para a maior GPIO e desloca para a
+ * esquerda, então a primeira linha varrida fica nos bits 15..12.
+ */
+void keypad_decoder_init(keypad_decoder_t *d, const unsigned rows[4], const unsigned columns[4])
+{
+    unsigned row_base = min4(rows);
+    unsigned col_base = min4(columns);
+
+    for (unsigned r = 0; r < 4; r++)
+        for (unsigned c = 0; c < 4; c++)
+            d->bitpos[r * 4 + c] = 4 * (3 - (rows[r] - row_base)) + (columns[c] - col_base);
+
+    d->state = 0;
+}
+
+/**
+ * Converte uma palavra da PIO no mapa de teclas (bit i = KEY_MAP[i]).
+ */
+uint16_t keypad_decode_word(const keypad_decoder_t *d, uint32_t word)
+{
+    uint16_t bits = 0;
+
+    for (unsigned i = 0; i < 16; i++)
+        if (word & (1u << d->bitpos[i]))
+            bits |= 1u << i;
+    return bits;
+}
+
+/**
+ * Aplica uma palavra da PIO e lista as teclas que mudaram. Retorna quantas.
+ */
+unsigned keypad_decoder_feed(keypad_decoder_t *d, uint32_t word, const char keymap[16], keypad_change_t out[16])
+{
+    uint16_t bits = keypad_decode_word(d, word);
+    uint16_t changed = bits ^ d->state;
+    unsigned n = 0;
+
+    for (unsigned i = 0; i < 16; i++)
+    {
+        if (changed & (1u << i))
+        {
+            out[n].key = keymap[i];
+            out[n].down = (bits >> i) & 1;
+            n++;
+        }
+    }
+
+    d->state = bits;
+    return n;
+}
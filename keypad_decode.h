@@ -0,0 +1,27 @@
+#ifndef KEYPAD_DECODE_H
+#define KEYPAD_DECODE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Decodificador das palavras enviadas pelo programa keypad_scan (keypad.pio).
+// Não depende do SDK, para poder ser exercitado no host.
+
+// Uma tecla que mudou de estado.
+typedef struct
+{
+    char key;
+    bool down;
+} keypad_change_t;
+
+typedef struct
+{
+    uint8_t bitpos[16]; // Bit da palavra da PIO correspondente a KEY_MAP[linha * 4 + coluna].
+    uint16_t state;     // Teclas pressionadas (bit i = KEY_MAP[i]).
+} keypad_decoder_t;
+
+void keypad_decoder_init(keypad_decoder_t *d, const unsigned rows[4], const unsigned columns[4]);
+uint16_t keypad_decode_word(const keypad_decoder_t *d, uint32_t word);
+unsigned keypad_decoder_feed(keypad_decoder_t *d, uint32_t word, const char keymap[16], keypad_change_t out[16]);
+
+#endif
@@ -0,0 +1,352 @@
+#include <string.h>
+#include "neopixel.h"
+#include "np_trace.h"
+#if NP_DUAL_CORE
+#include "np_ring.h"
+#include "hardware/sync.h"
+#endif
+#if NP_PARALLEL_STRIPS
+#include "np_parallel.h"
+#endif
+
+#if NP_DUAL_CORE
+// Os quadros ficam no anel de np_ring.c.
+npLED_t *leds;
+#else
+// Buffer de desenho. O DMA lê de wire, preenchido a partir dele em npWrite().
+static npLED_t framebuffer[LED_COUNT];
+npLED_t *leds = framebuffer;
+static uint16_t frame_seq = 0;
+#endif
+
+// Quadro já corrigido (brilho/gamma) que vai para o fio. No modo dual-core só o core1 usa.
+#if NP_PARALLEL_STRIPS
+static uint32_t wire[NP_PARALLEL_WORDS]; // Planos de bits das fitas (np_parallel.c).
+#else
+static npLED_t wire[LED_COUNT];
+#endif
+
+// Correção gamma 2.2 pré-calculada: round(255 * (i / 255) ^ 2.2).
+static const uint8_t gamma22[256] = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+    1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+    3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+    6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+    12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+    20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+    30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+    42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+    56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+    73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+    91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+// Tabelas de saída (brilho e gamma já aplicados). A nova é montada na que não
+// está publicada em lut e só é publicada pronta; no dual-core lut_in_use diz
+// qual o core1 está lendo em npPack, e essa não é regravada até ele terminar.
+static uint8_t luts[2][256];
+static const uint8_t *volatile lut = NULL; // NULL: tabela identidade (cópia direta).
+#if NP_DUAL_CORE
+static const uint8_t *volatile lut_in_use = NULL;
+#endif
+static uint8_t brightness = 255;
+static bool gamma_on = false;
+
+// LEDs [0, dirty_end) podem ter mudado desde o último envio; 0 = quadro igual ao enviado.
+static uint dirty_end = 0;
+static npWriteStats_t write_stats;
+
+static inline bool npIsOff(const npLED_t *p)
+{
+#if NP_PACKED_PIXELS
+    return p->GRB == 0;
+#else
+    return (p->G | p->R | p->B) == 0;
+#endif
+}
+
+/**
+ * Inicializa a saída para a matriz de LEDs.
+ */
+void npInit(uint pin)
+{
+    npHalLedInit(pin);
+
+#if NP_DUAL_CORE
+    npRingInit();
+#else
+    // Limpa buffers de pixels.
+    memset(framebuffer, 0, sizeof(framebuffer));
+#endif
+    // O estado dos LEDs no boot é desconhecido: o primeiro quadro vai inteiro.
+    dirty_end = LED_COUNT;
+}
+
+/**
+ * Atribui uma cor RGB a um LED.
+ */
+void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+#if NP_PACKED_PIXELS
+    uint32_t grb = NP_PACK(r, g, b);
+    if (leds[index].GRB == grb)
+        return;
+    leds[index].GRB = grb;
+#else
+    if (leds[index].R == r && leds[index].G == g && leds[index].B == b)
+        return;
+    leds[index].R = r;
+    leds[index].G = g;
+    leds[index].B = b;
+#endif
+    if (index >= dirty_end)
+        dirty_end = index + 1;
+}
+
+/**
+ * Limpa o buffer de pixels.
+ */
+void npClear()
+{
+    // Só até o último LED aceso: o resto já está apagado (e não fica sujo).
+    uint end = LED_COUNT;
+    while (end > 0 && npIsOff(&leds[end - 1]))
+        end--;
+    memset(leds, 0, end * sizeof(npLED_t));
+    if (end > dirty_end)
+        dirty_end = end;
+}
+
+/**
+ * Marca o quadro inteiro para envio (para quem escreve em leds[] diretamente).
+ */
+void npMarkDirty()
+{
+    dirty_end = LED_COUNT;
+}
+
+/**
+ * Copia os contadores de quadros enviados e pulados por não terem mudado.
+ */
+void npGetWriteStats(npWriteStats_t *out)
+{
+    *out = write_stats;
+}
+
+/**
+ * Regenera a tabela de saída para o brilho e o gamma atuais e reenvia o quadro inteiro.
+ */
+static void npUpdateLut(void)
+{
+    if (brightness == 255 && !gamma_on)
+        lut = NULL;
+    else
+    {
+        uint8_t *t = luts[lut == luts[0]];
+#if NP_DUAL_CORE
+        // Duas trocas durante um npPack: o core1 ainda pode estar na tabela anterior.
+        __dmb();
+        while (lut_in_use == t)
+            tight_loop_contents();
+#endif
+        for (uint i = 0; i < 256; i++)
+            t[i] = (uint8_t)(((gamma_on ? gamma22[i] : i) * brightness + 127) / 255);
+#if NP_DUAL_CORE
+        __dmb(); // A tabela inteira antes do ponteiro.
+#endif
+        lut = t;
+    }
+    npMarkDirty();
+}
+
+/**
+ * Toma a tabela publicada para um npPack no core1. Anuncia a tabela em
+ * lut_in_use e confere que ela ainda é a publicada, então npUpdateLut ou a vê
+ * em uso ou já publicou outra antes (e a próxima troca regrava a outra).
+ */
+static inline const uint8_t *npLutAcquire(void)
+{
+#if NP_DUAL_CORE
+    const uint8_t *t;
+    do
+    {
+        t = lut;
+        lut_in_use = t;
+        __dmb();
+    } while (t != lut);
+    return t;
+#else
+    return lut;
+#endif
+}
+
+static inline void npLutRelease(void)
+{
+#if NP_DUAL_CORE
+    __dmb();
+    lut_in_use = NULL;
+#endif
+}
+
+/**
+ * Define o brilho global (255 = cores como desenhadas). Não altera leds[].
+ */
+void npSetBrightness(uint8_t value)
+{
+    brightness = value;
+    npUpdateLut();
+}
+
+uint8_t npGetBrightness()
+{
+    return brightness;
+}
+
+/**
+ * Liga ou desliga a correção gamma 2.2 na saída.
+ */
+void npSetGamma(bool on)
+{
+    gamma_on = on;
+    npUpdateLut();
+}
+
+bool npGetGamma()
+{
+    return gamma_on;
+}
+
+#if NP_PARALLEL_STRIPS
+/**
+ * Monta os planos de bits de todas as fitas. Cada fita recebe sempre o quadro
+ * inteiro, então count (prefixo sujo) não se aplica; retorna LEDs por fita.
+ */
+static uint npPack(uint32_t *dst, const npLED_t *src, uint count, const uint8_t *t)
+{
+    (void)count;
+    npParallelPack(dst, src, NP_PARALLEL_STRIPS, NP_STRIP_LEN, t);
+    return NP_STRIP_LEN;
+}
+#else
+/**
+ * Copia count pixels para o buffer do fio passando cada canal pela tabela de
+ * saída t (NULL: cópia direta); retorna quantos LEDs enviar.
+ */
+static uint npPack(npLED_t *dst, const npLED_t *src, uint count, const uint8_t *t)
+{
+    if (t == NULL)
+    {
+        memcpy(dst, src, count * sizeof(npLED_t));
+        return count;
+    }
+    for (uint i = 0; i < count; i++)
+    {
+#if NP_PACKED_PIXELS
+        uint32_t w = src[i].GRB;
+        dst[i].GRB = t[w & 0xFF] | (uint32_t)t[(w >> 8) & 0xFF] << 8 | (uint32_t)t[(w >> 16) & 0xFF] << 16;
+#else
+        dst[i].G = t[src[i].G];
+        dst[i].R = t[src[i].R];
+        dst[i].B = t[src[i].B];
+#endif
+    }
+    return count;
+}
+#endif
+
+/**
+ * Indica se o último quadro já foi enviado e o RESET já terminou.
+ */
+bool npWriteDone()
+{
+#if NP_DUAL_CORE
+    return npRingReady();
+#else
+    return npHalLedIdle();
+#endif
+}
+
+/**
+ * Aguarda o fim da transmissão em andamento (incluindo o RESET).
+ */
+void npWaitWrite()
+{
+#if NP_DUAL_CORE
+    while (!npRingReady())
+        tight_loop_contents();
+#else
+    npHalLedWait();
+#endif
+}
+
+/**
+ * Registra o callback de fim de transmissão (NULL desativa).
+ */
+void npSetWriteCallback(npWriteCallback_t callback)
+{
+    npHalLedSetCallback(callback);
+}
+
+/**
+ * Envia o buffer de desenho para os LEDs sem bloquear durante a transmissão.
+ * Só espera se o quadro anterior ainda estiver sendo enviado. Um quadro igual
+ * ao último enviado é pulado; com NP_DIRTY_PREFIX só vai até o último LED alterado.
+ */
+void npWrite()
+{
+    if (dirty_end == 0)
+    {
+        write_stats.skipped++;
+        npTrace(NP_EV_FRAME_SKIP, 0, 0);
+        return;
+    }
+
+#if NP_DUAL_CORE
+    if (npRingPublish())
+    {
+        write_stats.sent++;
+        write_stats.leds_sent += LED_COUNT;
+        dirty_end = 0;
+    }
+#else
+    uint64_t t0 = npHalTimeUs();
+    if (!npHalLedIdle())
+    {
+        npWaitWrite();
+        uint64_t t1 = npHalTimeUs();
+        npTrace(NP_EV_STALL, 0, (uint16_t)(t1 - t0));
+        t0 = t1;
+    }
+
+    // O buffer de desenho continua com o quadro (as animações desenham de forma
+    // incremental); só a parte alterada passa pela tabela para o buffer do fio.
+#if NP_DIRTY_PREFIX && !NP_PARALLEL_STRIPS
+    uint count = dirty_end;
+#else
+    uint count = LED_COUNT;
+#endif
+    uint len = npPack(wire, leds, count, lut);
+    dirty_end = 0;
+    write_stats.sent++;
+    write_stats.leds_sent += count;
+
+    npTrace(NP_EV_FRAME_START, 0, frame_seq++);
+    npHalLedSend(wire, len);
+    npTrace(NP_EV_WRITE, 0, (uint16_t)(npHalTimeUs() - t0));
+#endif
+}
+
+/**
+ * Envia um quadro e só retorna depois do RESET (usado pelo core1 no modo dual-core).
+ */
+void npTransmitBlocking(const npLED_t *buf)
+{
+    uint len = npPack(wire, buf, LED_COUNT, npLutAcquire());
+    npLutRelease();
+    npHalLedSendBlocking(wire, len);
+}
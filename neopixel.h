@@ -0,0 +1,101 @@
+#ifndef NEOPIXEL_H
+#define NEOPIXEL_H
+
+#include "np_hal.h"
+
+// Definição do número de LEDs e pino.
+#ifndef LED_COUNT
+#define LED_COUNT 25
+#endif
+#define LED_PIN 7
+
+// 1: um pixel por palavra de 32 bits e ws2818b com autopull de 24 bits (uma escrita na FIFO por LED).
+// 0: pixels de 3 bytes e autopull de 8 bits (três escritas por LED).
+#ifndef NP_PACKED_PIXELS
+#define NP_PACKED_PIXELS 1
+#endif
+
+// 1: o core1 assume a saída dos LEDs (troca de quadros, DMA e RESET) e npWrite()
+// apenas publica o quadro num anel lock-free (np_ring.c). 0: tudo roda no core0.
+#ifndef NP_DUAL_CORE
+#define NP_DUAL_CORE 0
+#endif
+#if NP_DUAL_CORE && defined(NP_HOST)
+#error "NP_DUAL_CORE depende do SIO/multicore do RP2040"
+#endif
+
+// 1: npWrite() envia só até o último LED alterado; os LEDs seguintes da cadeia
+// mantêm a cor (o WS2812 só troca de cor no RESET e só para os bits que recebeu).
+#ifndef NP_DIRTY_PREFIX
+#define NP_DIRTY_PREFIX 1
+#endif
+
+// > 0: saída paralela para até 8 fitas em GPIOs consecutivas a partir de
+// NP_PARALLEL_PIN_BASE, todas alimentadas por uma máquina PIO (ws2818b_parallel).
+// LED_COUNT é o total, dividido igualmente entre as fitas (ver np_parallel.h).
+#ifndef NP_PARALLEL_STRIPS
+#define NP_PARALLEL_STRIPS 0
+#endif
+#ifndef NP_PARALLEL_PIN_BASE
+#define NP_PARALLEL_PIN_BASE LED_PIN
+#endif
+#if NP_PARALLEL_STRIPS > 8 || (NP_PARALLEL_STRIPS && LED_COUNT % NP_PARALLEL_STRIPS)
+#error "NP_PARALLEL_STRIPS: até 8 fitas, e LED_COUNT precisa ser múltiplo do número de fitas"
+#endif
+
+#if NP_PACKED_PIXELS
+// Definição de pixel GRB empacotado: os bytes G, R, B ocupam os bits 0..23 da
+// palavra (0x00BBRRGG), na mesma ordem em que o programa de 8 bits os envia.
+union pixel_t
+{
+    struct
+    {
+        uint8_t G, R, B; // Três valores de 8-bits compõem um pixel.
+    };
+    uint32_t GRB; // O mesmo pixel como palavra pronta para a FIFO.
+};
+typedef union pixel_t pixel_t;
+#else
+// Definição de pixel GRB
+struct pixel_t
+{
+    uint8_t G, R, B; // Três valores de 8-bits compõem um pixel.
+};
+typedef struct pixel_t pixel_t;
+#endif
+typedef pixel_t npLED_t; // Mudança de nome de "struct pixel_t" para "npLED_t" por clareza.
+
+// Empacota uma cor RGB no formato de palavra usado por npLED_t.GRB.
+#define NP_PACK(r, g, b) ((uint32_t)(g) | ((uint32_t)(r) << 8) | ((uint32_t)(b) << 16))
+
+// Buffer de desenho. Guarda as cores como desenhadas: brilho e gamma só são
+// aplicados na cópia para o fio. No modo dual-core aponta para o quadro atual do anel.
+extern npLED_t *leds;
+
+// Contadores de npWrite().
+typedef struct
+{
+    uint32_t sent;      // Quadros enviados.
+    uint32_t skipped;   // Quadros iguais ao anterior, não enviados.
+    uint32_t leds_sent; // LEDs transmitidos (menor que sent * LED_COUNT com NP_DIRTY_PREFIX).
+} npWriteStats_t;
+
+// Callback chamado (em contexto de interrupção) quando o DMA termina de enviar um quadro.
+typedef void (*npWriteCallback_t)(void);
+
+void npInit(uint pin);
+void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b);
+void npClear();
+void npMarkDirty();
+void npGetWriteStats(npWriteStats_t *stats);
+void npSetBrightness(uint8_t value);
+uint8_t npGetBrightness();
+void npSetGamma(bool on);
+bool npGetGamma();
+void npWrite();
+bool npWriteDone();
+void npWaitWrite();
+void npSetWriteCallback(npWriteCallback_t callback);
+void npTransmitBlocking(const npLED_t *buf);
+
+#endif
@@ -0,0 +1,85 @@
+#include "np_anim.h"
+#include "neopixel.h"
+#include "np_tween.h"
+
+/**
+ * Aplica um quadro da tabela ao buffer de pixels.
+ */
+void npAnimRenderFrame(const npAnimation_t *anim, uint16_t frame)
+{
+    const npFrame_t *f = &anim->frames[frame];
+
+    if (f->flags & NP_FRAME_CLEAR)
+        npClear();
+
+    for (uint i = 0; i < f->count; ++i)
+    {
+        const npColor_t *c = &anim->palette[f->pixels[i].color];
+        npSetLED(f->pixels[i].index, c->r, c->g, c->b);
+    }
+}
+
+/**
+ * Prepara o player para reproduzir a animação desde o início.
+ */
+void npAnimStart(npAnimPlayer_t *p, const npAnimation_t *anim)
+{
+    p->anim = anim;
+    p->frame = 0;
+    p->loop = 0;
+    p->transition = NULL;
+}
+
+/**
+ * Liga o crossfade entre os quadros (depois de npAnimStart); o quadro atual é a origem.
+ */
+void npAnimSetTransition(npAnimPlayer_t *p, npTransition_t *x)
+{
+    p->transition = x;
+    if (x)
+        npTransitionCapture(x);
+}
+
+/**
+ * Desenha e envia o próximo quadro sem esperar (ou o próximo passo do crossfade).
+ * Retorna o tempo até o próximo passo em ms, ou -1 quando a animação terminou.
+ */
+int32_t npAnimStep(npAnimPlayer_t *p)
+{
+    const npAnimation_t *anim = p->anim;
+    int32_t ms;
+
+    if (p->transition && (ms = npTransitionStep(p->transition)) >= 0)
+        return ms;
+
+    if (p->frame >= anim->frame_count)
+    {
+        if (++p->loop >= anim->loops)
+        {
+            if (anim->flags & NP_ANIM_CLEAR_END)
+                npClear();
+            return -1;
+        }
+        p->frame = 0;
+    }
+
+    npAnimRenderFrame(anim, p->frame);
+    ms = anim->frames[p->frame++].duration_ms;
+    if (p->transition)
+        return npTransitionBegin(p->transition, (uint32_t)ms);
+    npWrite();
+    return ms;
+}
+
+/**
+ * Reproduz uma animação completa (bloqueante).
+ */
+void npAnimPlay(const npAnimation_t *anim)
+{
+    npAnimPlayer_t p;
+    int32_t ms;
+
+    npAnimStart(&p, anim);
+    while ((ms = npAnimStep(&p)) >= 0)
+        npHalSleepUs((uint64_t)ms * 1000);
+}
@@ -0,0 +1,74 @@
+#ifndef NP_ANIM_H
+#define NP_ANIM_H
+
+#include <stdint.h>
+
+typedef struct npTransition_t npTransition_t;
+
+// Cor de uma entrada da paleta.
+typedef struct
+{
+    uint8_t r, g, b;
+} npColor_t;
+
+// Um LED aceso no quadro: índice no buffer e índice da cor na paleta.
+typedef struct
+{
+    uint8_t index;
+    uint8_t color;
+} npPixel_t;
+
+// Flags de quadro.
+#define NP_FRAME_CLEAR 0x01 // Limpa o buffer antes de aplicar a lista de pixels.
+
+// Um quadro da animação: lista de pixels aplicada sobre o quadro anterior.
+typedef struct
+{
+    uint16_t duration_ms; // Tempo de exibição do quadro.
+    uint8_t flags;
+    uint8_t count;           // Número de pixels na lista.
+    const npPixel_t *pixels; // Lista de pixels (em flash).
+} npFrame_t;
+
+// Flags de animação.
+#define NP_ANIM_CLEAR_END 0x01 // Limpa o buffer (sem enviar) ao terminar a animação.
+
+// Tabela de quadros de uma animação, inteiramente constante (fica na flash).
+typedef struct
+{
+    const npColor_t *palette;
+    const npFrame_t *frames;
+    uint16_t frame_count;
+    uint8_t loops; // Quantas vezes a sequência é repetida.
+    uint8_t flags;
+} npAnimation_t;
+
+// Declara um quadro a partir de uma lista de pares {índice, cor}.
+#define NP_FRAME(ms, flags, ...)                                          \
+    {                                                                     \
+        (ms), (flags),                                                    \
+            sizeof((const npPixel_t[]){__VA_ARGS__}) / sizeof(npPixel_t), \
+            (const npPixel_t[]){__VA_ARGS__}                              \
+    }
+
+// Declara um quadro sem pixels (apenas espera, ou limpa com NP_FRAME_CLEAR).
+#define NP_FRAME_EMPTY(ms, flags) {(ms), (flags), 0, 0}
+
+#define NP_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+// Estado de reprodução de uma tabela, avançado um quadro por passo.
+typedef struct
+{
+    const npAnimation_t *anim;
+    uint16_t frame;
+    uint8_t loop;
+    npTransition_t *transition; // Crossfade entre quadros (np_tween.h); NULL = troca direta.
+} npAnimPlayer_t;
+
+void npAnimRenderFrame(const npAnimation_t *anim, uint16_t frame);
+void npAnimStart(npAnimPlayer_t *p, const npAnimation_t *anim);
+void npAnimSetTransition(npAnimPlayer_t *p, npTransition_t *x);
+int32_t npAnimStep(npAnimPlayer_t *p);
+void npAnimPlay(const npAnimation_t *anim);
+
+#endif
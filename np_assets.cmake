@@ -0,0 +1,25 @@
+# Animações em texto (anim/*.npa) compiladas por host/np_assetc.c para fluxos
+# np_delta constantes. Gera np_assets.c e o relatório de tamanho np_assets.txt
+# no diretório de build; o relatório também sai no log do build. As mesmas
+# animações formam a imagem da biblioteca np_biblioteca.bin (np_library.h),
+# para enviar com np_stream_send -u.
+
+set(NP_ASSET_FILES
+        ${CMAKE_CURRENT_LIST_DIR}/anim/tetrix.npa
+        ${CMAKE_CURRENT_LIST_DIR}/anim/ondas.npa
+        )
+
+# np_assets_generate(<var> <np_assetc> <dependência>): regra que gera np_assets.c
+# (caminho em <var>) e o alvo np_assets, do qual os alvos que o compilam dependem.
+function(np_assets_generate var assetc dep)
+    set(out ${CMAKE_BINARY_DIR}/np_assets.c)
+    set(report ${CMAKE_BINARY_DIR}/np_assets.txt)
+    set(library ${CMAKE_BINARY_DIR}/np_biblioteca.bin)
+    add_custom_command(OUTPUT ${out} ${report} ${library}
+            COMMAND ${assetc} -o ${out} -r ${report} -b ${library} ${NP_ASSET_FILES}
+            DEPENDS ${NP_ASSET_FILES} ${dep}
+            COMMENT "np_assetc: anim/*.npa -> np_assets.c"
+            VERBATIM)
+    add_custom_target(np_assets DEPENDS ${out})
+    set(${var} ${out} PARENT_SCOPE)
+endfunction()
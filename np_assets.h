@@ -0,0 +1,14 @@
+#ifndef NP_ASSETS_H
+#define NP_ASSETS_H
+
+#include "np_delta.h"
+
+// Animações compiladas de anim/*.npa por host/np_assetc.c (ver np_assets.cmake).
+// Cada uma vira um fluxo np_delta constante (flash) com o nome anim_<nome> e uma
+// entrada nesta tabela. Todas tocam pelo mesmo npDeltaStep, então uma animação
+// nova só ocupa dados, sem código novo.
+extern const npDeltaAnim_t *const np_assets[];
+extern const char *const np_asset_names[];
+extern const uint16_t np_asset_count;
+
+#endif
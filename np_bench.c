@@ -0,0 +1,254 @@
+#ifdef NP_HOST
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "np_host.h"
+#endif
+#include <stdio.h>
+#include "neopixel.h"
+#include "animacoes.h"
+#include "np_parallel.h"
+#include "np_text.h"
+#include "np_sprite.h"
+#include "np_layout.h"
+#include "np_fire.h"
+#include "np_tween.h"
+
+// Benchmark do caminho de renderização: operações no framebuffer, empacotamento
+// dos pixels, envio (npWrite) e o passo de cada animação. LED_COUNT é fixo na
+// compilação, então há um executável por tamanho (np_bench_25, _256, _1024).
+// Saída em CSV: nome,leds,iteracoes,valor,unidade.
+// No host o tempo de CPU é real e o tempo de fio é o do relógio virtual de np_hal_host.c.
+
+// Duração mínima de cada medição.
+#define NP_BENCH_MIN_NS 20000000ull
+
+// Limite de tempo de fio nas medições que esperam o envio (1024 LEDs = ~31ms por quadro).
+#define NP_BENCH_MAX_WIRE_US 1000000ull
+
+typedef void (*npBenchFn_t)(void);
+
+static uint64_t agoraNs(void)
+{
+#ifdef NP_HOST
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#else
+    return time_us_64() * 1000;
+#endif
+}
+
+/**
+ * O backend de host guarda todos os quadros enviados; descarta entre as medições.
+ */
+static void descartaCaptura(void)
+{
+#ifdef NP_HOST
+    npHostReset();
+#endif
+}
+
+static void resultado(const char *nome, uint32_t iteracoes, double valor, const char *unidade)
+{
+    printf("%s,%u,%u,%.1f,%s\n", nome, LED_COUNT, (unsigned)iteracoes, valor, unidade);
+}
+
+/**
+ * Repete fn em lotes dobrando de tamanho até passar de NP_BENCH_MIN_NS e imprime ns por chamada.
+ */
+static void medir(const char *nome, npBenchFn_t fn)
+{
+    for (uint32_t n = 1;; n *= 2)
+    {
+        uint64_t t0 = agoraNs();
+        for (uint32_t i = 0; i < n; i++)
+            fn();
+        uint64_t dt = agoraNs() - t0;
+        if (dt >= NP_BENCH_MIN_NS)
+        {
+            resultado(nome, n, (double)dt / n, "ns");
+            return;
+        }
+    }
+}
+
+static void benchClear(void)
+{
+    npClear();
+}
+
+// Empacotamento: um npSetLED por LED, com cores diferentes a cada chamada.
+static uint8_t cor_bench;
+
+static void benchSetLED(void)
+{
+    uint8_t c = cor_bench++;
+    for (uint i = 0; i < LED_COUNT; i++)
+        npSetLED(i, c, (uint8_t)(c + i), (uint8_t)(c ^ i));
+}
+
+static uint16_t quadro_bench;
+
+static void benchCoracao(void)
+{
+    npAnimRenderFrame(&anim_coracao, quadro_bench);
+    quadro_bench = (quadro_bench + 1) % anim_coracao.frame_count;
+}
+
+// Fogo procedural: simulação e conversão para cor de um quadro, sem o envio.
+static npFire_t fogo_bench;
+
+static void benchFogo(void)
+{
+    npFireUpdate(&fogo_bench);
+    npFireRender(&fogo_bench);
+}
+
+static void benchFogoSimulacao(void)
+{
+    npFireUpdate(&fogo_bench);
+}
+
+static npDeltaDecoder_t decoder_bench;
+
+static void benchTetrix(void)
+{
+    if (npDeltaNextFrame(&decoder_bench) < 0)
+    {
+        npDeltaStart(&decoder_bench, &anim_tetrix);
+        npDeltaNextFrame(&decoder_bench);
+    }
+}
+
+// Letreiro: a janela custa o mesmo em qualquer ponto da mensagem.
+static npMarquee_t letreiro_bench;
+static uint8_t colunas_bench[512];
+
+static void benchLetreiro(void)
+{
+    npMarqueeRender(&letreiro_bench);
+    if (++letreiro_bench.pos == letreiro_bench.len)
+        letreiro_bench.pos = 0;
+}
+
+// Sprites: 16 peças andando na diagonal, parte delas recortada nas bordas.
+static int sprite_passo;
+
+static void benchSprites(void)
+{
+    npClear();
+    for (int k = 0; k < 16; k++)
+        npBlit(&sprites_tetromino[k % 7], (k * 3 + sprite_passo) % (NP_WIDTH + 4) - 2,
+               (k * 5 + sprite_passo) % (NP_HEIGHT + 4) - 2, 10, 5, 0);
+    sprite_passo++;
+}
+
+// Crossfade: um quadro inteiro interpolado entre dois quadros-chave.
+static npLED_t chave_bench[2][LED_COUNT];
+static uint alpha_bench;
+
+static void benchTween(void)
+{
+    npLerpFrame(leds, chave_bench[0], chave_bench[1], LED_COUNT, alpha_bench);
+    alpha_bench = (alpha_bench + 7) & 255;
+}
+
+// Saída paralela: LED_COUNT dividido em 8 fitas, independente de NP_PARALLEL_STRIPS.
+static uint32_t planos_bench[6 * ((LED_COUNT + 7) / 8)];
+
+static void benchTransposicao(void)
+{
+    npParallelPack(planos_bench, leds, 8, LED_COUNT / 8, NULL);
+}
+
+/**
+ * npWrite: custo de CPU (passar o quadro inteiro pela tabela de brilho/gamma
+ * para o buffer do fio em npPack e iniciar o DMA) e o quadro completo até o
+ * fim do RESET, que limita o FPS.
+ */
+static double medirEnvio(const char *nome_cpu, const char *nome_quadro)
+{
+    uint64_t cpu = 0, fio = 0;
+    uint32_t n = 0;
+
+    npWaitWrite();
+    while (n < 16 || (cpu < NP_BENCH_MIN_NS && fio < NP_BENCH_MAX_WIRE_US))
+    {
+        if ((n & 255) == 0)
+            descartaCaptura();
+        npMarkDirty(); // Quadro completo, sem o atalho de quadro repetido.
+        uint64_t t0 = agoraNs();
+        uint64_t q0 = npHalTimeUs();
+        npWrite();
+        cpu += agoraNs() - t0;
+        npWaitWrite();
+        fio += npHalTimeUs() - q0;
+        n++;
+    }
+
+    resultado(nome_cpu, n, (double)cpu / n, "ns");
+    double quadro_us = (double)fio / n;
+    resultado(nome_quadro, n, quadro_us, "us");
+    return quadro_us;
+}
+
+/**
+ * Executa todas as medições para o LED_COUNT desta compilação.
+ */
+static void npBenchRun(void)
+{
+    printf("nome,leds,iteracoes,valor,unidade\n");
+
+    descartaCaptura();
+    medir("npClear", benchClear);
+    medir("npSetLED_todos", benchSetLED);
+    double quadro_us = medirEnvio("npWrite", "quadro");
+
+    // Com brilho < 255 cada canal passa pela tabela de saída em vez de uma cópia direta.
+    npSetBrightness(128);
+    medirEnvio("npWrite_brilho", "quadro_brilho");
+    npSetBrightness(255);
+
+    quadro_bench = 0;
+    medir("coracao_render", benchCoracao);
+    npFireStart(&fogo_bench, 60, 30, 0);
+    medir("fogo_render", benchFogo);
+    medir("fogo_simulacao", benchFogoSimulacao);
+    npDeltaStart(&decoder_bench, &anim_tetrix);
+    medir("tetrix_decode", benchTetrix);
+    medir("transposicao_8fitas", benchTransposicao);
+    medir("sprites_16", benchSprites);
+    for (uint i = 0; i < LED_COUNT; i++)
+    {
+        chave_bench[0][i].R = (uint8_t)i;
+        chave_bench[1][i].B = (uint8_t)(255 - i);
+    }
+    medir("tween_quadro", benchTween);
+    uint colunas = npTextColumns(colunas_bench, sizeof(colunas_bench), "ANIMACOES NEOPIXEL - EMBARCATECH 2025");
+    npMarqueeStart(&letreiro_bench, colunas_bench, (uint16_t)colunas, (npColor_t){0, 0, 10}, 100, 0);
+    medir("letreiro_render", benchLetreiro);
+
+    resultado("fps_max", 1, 1e6 / quadro_us, "fps");
+    npClear();
+    npWrite();
+    npWaitWrite();
+}
+
+int main(void)
+{
+#ifdef NP_HOST
+    npInit(LED_PIN);
+    npBenchRun();
+    return 0;
+#else
+    stdio_init_all();
+    npInit(LED_PIN);
+    sleep_ms(2000); // Tempo para o terminal USB conectar.
+
+    while (true)
+    {
+        npBenchRun();
+        sleep_ms(5000);
+    }
+#endif
+}
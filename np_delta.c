@@ -0,0 +1,185 @@
+#include "np_delta.h"
+#include "neopixel.h"
+#include "np_layout.h"
+#include "np_tween.h"
+
+/**
+ * Pinta a posição pos (ordem de varredura) com uma cor da paleta, ignorando posições fora da matriz.
+ */
+static inline void npDeltaSet(const npColor_t *palette, uint pos, uint8_t color)
+{
+    if (pos < NP_LAYOUT_CELLS)
+        npSetLED(np_layout[pos], palette[color].r, palette[color].g, palette[color].b);
+}
+
+/**
+ * Percorre o fluxo inteiro uma vez sem desenhar: cada quadro precisa caber em
+ * data[0..size) e terminar com NPD_END, os quadros precisam ser exatamente
+ * frame_count e toda cor precisa existir na paleta. Retorna false se algo falhar.
+ */
+bool npDeltaValidate(const npDeltaAnim_t *anim)
+{
+    const uint8_t *p = anim->data;
+    const uint8_t *end = anim->data + anim->size;
+
+    if (anim->frame_count == 0 || anim->colors == 0)
+        return false;
+
+    for (uint frame = 0; frame < anim->frame_count; ++frame)
+    {
+        if (end - p < 2)
+            return false;
+        p += 2; // Duração.
+
+        for (;;)
+        {
+            if (p >= end)
+                return false; // Quadro sem NPD_END.
+            uint8_t op = *p++;
+            uint n = (op & ~NPD_OP_MASK) + 1;
+
+            if (op == NPD_END)
+                break;
+
+            switch (op & NPD_OP_MASK)
+            {
+            case NPD_OP_SKIP:
+                break;
+            case NPD_OP_RUN:
+                n = 1;
+                // fall through
+            case NPD_OP_LIT:
+                if ((uint)(end - p) < n)
+                    return false;
+                while (n--)
+                    if (*p++ >= anim->colors)
+                        return false;
+                break;
+            default:
+                if (op != NPD_OP_FILL || p >= end || *p++ >= anim->colors)
+                    return false;
+                break;
+            }
+        }
+    }
+    return p == end;
+}
+
+/**
+ * Prepara o decodificador para reproduzir a animação desde o início.
+ */
+void npDeltaStart(npDeltaDecoder_t *d, const npDeltaAnim_t *anim)
+{
+    d->anim = anim;
+    d->pos = 0;
+    d->frame = 0;
+    d->loop = 0;
+    d->transition = NULL;
+}
+
+/**
+ * Liga o crossfade entre os quadros (depois de npDeltaStart); o quadro atual é a origem.
+ */
+void npDeltaSetTransition(npDeltaDecoder_t *d, npTransition_t *x)
+{
+    d->transition = x;
+    if (x)
+        npTransitionCapture(x);
+}
+
+/**
+ * Aplica o próximo quadro diretamente sobre o buffer de pixels.
+ * Retorna a duração do quadro em ms, ou -1 quando a animação terminou.
+ */
+int32_t npDeltaNextFrame(npDeltaDecoder_t *d)
+{
+    const npDeltaAnim_t *a = d->anim;
+
+    if (d->frame >= a->frame_count)
+    {
+        if (++d->loop >= a->loops)
+        {
+            if (a->flags & NP_ANIM_CLEAR_END)
+                npClear();
+            return -1;
+        }
+        d->pos = 0;
+        d->frame = 0;
+    }
+
+    const uint8_t *p = a->data + d->pos;
+    const uint8_t *end = a->data + a->size;
+    int32_t duration = p[0] | (p[1] << 8);
+    p += 2;
+
+    uint cursor = 0;
+    while (p < end)
+    {
+        uint8_t op = *p++;
+        uint n = (op & ~NPD_OP_MASK) + 1;
+
+        if (op == NPD_END)
+            break;
+
+        switch (op & NPD_OP_MASK)
+        {
+        case NPD_OP_SKIP:
+            cursor += n;
+            break;
+        case NPD_OP_RUN:
+            for (uint8_t c = *p++; n--; ++cursor)
+                npDeltaSet(a->palette, cursor, c);
+            break;
+        case NPD_OP_LIT:
+            while (n--)
+                npDeltaSet(a->palette, cursor++, *p++);
+            break;
+        default:
+            if (op == NPD_OP_FILL)
+            {
+                // A ordem não importa: pinta a cadeia inteira direto.
+                const npColor_t *c = &a->palette[*p++];
+                for (uint i = 0; i < LED_COUNT; ++i)
+                    npSetLED(i, c->r, c->g, c->b);
+            }
+            break;
+        }
+    }
+
+    d->pos = p - a->data;
+    d->frame++;
+    return duration;
+}
+
+/**
+ * Decodifica e envia o próximo quadro sem esperar (ou o próximo passo do crossfade).
+ * Retorna o tempo até o próximo passo em ms, ou -1 quando a animação terminou.
+ */
+int32_t npDeltaStep(npDeltaDecoder_t *d)
+{
+    int32_t ms;
+
+    if (d->transition && (ms = npTransitionStep(d->transition)) >= 0)
+        return ms;
+
+    ms = npDeltaNextFrame(d);
+    if (ms < 0)
+        return ms;
+    if (d->transition)
+        return npTransitionBegin(d->transition, (uint32_t)ms);
+    npWrite();
+    return ms;
+}
+
+/**
+ * Reproduz uma animação compactada completa (bloqueante).
+ */
+void npDeltaPlay(const npDeltaAnim_t *anim)
+{
+    npDeltaDecoder_t d;
+    int32_t ms;
+
+    npDeltaStart(&d, anim);
+    while ((ms = npDeltaStep(&d)) >= 0)
+        npHalSleepUs((uint64_t)ms * 1000);
+}
@@ -0,0 +1,67 @@
+#ifndef NP_DELTA_H
+#define NP_DELTA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "np_anim.h"
+
+// Formato compactado de animação (delta + RLE).
+//
+// O fluxo é uma sequência de quadros. Cada quadro começa com a duração em ms
+// (16 bits, little-endian) seguida de comandos que alteram o buffer a partir
+// de um cursor que começa em (0, 0) e anda em ordem de varredura (x, depois y),
+// convertido para o LED pela tabela de np_layout.h:
+//
+//   0x00             fim do quadro
+//   0x01 c           preenche todos os LEDs com a cor c (quadro-chave)
+//   0x40 | (n - 1)   avança o cursor n LEDs sem alterá-los (n <= 64)
+//   0x80 | (n - 1) c pinta n LEDs seguidos com a cor c (n <= 64)
+//   0xC0 | (n - 1)   pinta n LEDs com as n cores que vêm em seguida (n <= 64)
+//
+// Cores são índices na paleta da animação. Só os LEDs que mudam são tocados.
+//
+// O decodificador confia no fluxo: só o cursor de escrita é limitado à matriz.
+// Fluxos gerados por host/np_assetc.c são válidos por construção; os que vêm de
+// fora (biblioteca gravada pela USB) passam antes por npDeltaValidate.
+#define NPD_END 0x00
+#define NPD_FILL(c) 0x01, (c)
+#define NPD_SKIP(n) (0x40 | ((n) - 1))
+#define NPD_RUN(n, c) (0x80 | ((n) - 1)), (c)
+#define NPD_LIT(n) (0xC0 | ((n) - 1))
+#define NPD_MS(ms) ((ms) & 0xFF), ((ms) >> 8)
+
+#define NPD_OP_MASK 0xC0
+#define NPD_OP_SKIP 0x40
+#define NPD_OP_RUN 0x80
+#define NPD_OP_LIT 0xC0
+#define NPD_OP_FILL 0x01
+
+typedef struct
+{
+    const npColor_t *palette;
+    uint16_t colors;     // Cores na paleta.
+    const uint8_t *data; // Fluxo de quadros (em flash).
+    uint32_t size;
+    uint16_t frame_count;
+    uint8_t loops;
+    uint8_t flags; // NP_ANIM_CLEAR_END
+} npDeltaAnim_t;
+
+// Estado do decodificador: só a posição no fluxo, nenhum quadro extra em RAM.
+typedef struct
+{
+    const npDeltaAnim_t *anim;
+    uint32_t pos;
+    uint16_t frame;
+    uint8_t loop;
+    npTransition_t *transition; // Crossfade entre quadros (np_tween.h); NULL = troca direta.
+} npDeltaDecoder_t;
+
+bool npDeltaValidate(const npDeltaAnim_t *anim);
+void npDeltaStart(npDeltaDecoder_t *d, const npDeltaAnim_t *anim);
+void npDeltaSetTransition(npDeltaDecoder_t *d, npTransition_t *x);
+int32_t npDeltaNextFrame(npDeltaDecoder_t *d);
+int32_t npDeltaStep(npDeltaDecoder_t *d);
+void npDeltaPlay(const npDeltaAnim_t *anim);
+
+#endif
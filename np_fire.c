@@ -0,0 +1,135 @@
+#include <string.h>
+#include "np_fire.h"
+
+// Operações em quatro bytes de uma vez (SWAR). As faixas nunca transbordam.
+#define NP_LANE_H 0x80808080u
+
+/**
+ * Média de cada byte de a e b, arredondada para baixo.
+ */
+static inline uint32_t npAvg4(uint32_t a, uint32_t b)
+{
+    return (a & b) + (((a ^ b) & 0xFEFEFEFEu) >> 1);
+}
+
+/**
+ * a - b em cada byte, parando em 0.
+ */
+static inline uint32_t npSubSat4(uint32_t a, uint32_t b)
+{
+    uint32_t d = ((a | NP_LANE_H) - (b & ~NP_LANE_H)) ^ ((a ^ ~b) & NP_LANE_H);
+    uint32_t borrow = ((~a & b) | (~(a ^ b) & d)) & NP_LANE_H;
+    return d & ~((borrow >> 7) * 0xFF);
+}
+
+static inline uint32_t npFireRand(npFire_t *f)
+{
+    uint32_t x = f->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return f->rng = x;
+}
+
+/**
+ * Prepara a simulação com a grade fria. O resfriamento é ajustado à altura da
+ * matriz para as chamas chegarem perto do topo em qualquer tamanho.
+ */
+void npFireStart(npFire_t *f, uint8_t level, uint16_t frame_ms, uint32_t frames)
+{
+    memset(f->heat, 0, sizeof(f->heat));
+    f->rng = 0x2545F491u;
+    f->level = level;
+    f->frame_ms = frame_ms;
+    f->frames = frames;
+    f->frame = 0;
+
+    // Resfriamento médio por linha ~ 320 / altura: máscara 2^k - 1 logo acima.
+    uint k = 0;
+    while (k < 7 && (1u << k) < 640 / NP_HEIGHT)
+        k++;
+    f->cool = ((1u << k) - 1) * 0x01010101u;
+
+    uint lanes = NP_WIDTH - 4 * (NP_FIRE_ROW_WORDS - 1);
+    f->edge = lanes == 4 ? ~0u : (1u << (8 * lanes)) - 1;
+}
+
+/**
+ * Avança a simulação um quadro. Cada célula recebe a média de três vizinhas
+ * da linha de baixo e da célula duas linhas abaixo, menos um resfriamento
+ * aleatório; a linha de baixo recebe faíscas novas.
+ */
+void npFireUpdate(npFire_t *f)
+{
+    const uint n = NP_FIRE_ROW_WORDS;
+
+    // De cima para baixo: as linhas de baixo ainda têm os valores do quadro anterior.
+    for (int y = NP_HEIGHT - 1; y > 0; y--)
+    {
+        const uint32_t *b1 = f->heat[y - 1];
+        const uint32_t *b2 = f->heat[y > 1 ? y - 2 : 0];
+        uint32_t *row = f->heat[y];
+
+        for (uint j = 0; j < n; j++)
+        {
+            // Vizinhas à esquerda e à direita: desloca uma faixa puxando o byte da palavra ao lado.
+            uint32_t c = b1[j];
+            uint32_t l = c << 8 | (j > 0 ? b1[j - 1] >> 24 : 0);
+            uint32_t r = c >> 8 | (j + 1 < n ? b1[j + 1] << 24 : 0);
+            uint32_t v = npAvg4(npAvg4(l, r), npAvg4(c, b2[j]));
+            row[j] = npSubSat4(v, npFireRand(f) & f->cool);
+        }
+        row[n - 1] &= f->edge;
+    }
+
+    // Base: faíscas entre 128 e 255, suavizadas com o quadro anterior.
+    for (uint j = 0; j < n; j++)
+        f->heat[0][j] = npAvg4(f->heat[0][j], npFireRand(f) | NP_LANE_H);
+    f->heat[0][n - 1] &= f->edge;
+}
+
+/**
+ * Converte o calor em cor e desenha no buffer pela tabela da matriz.
+ */
+void npFireRender(const npFire_t *f)
+{
+    const uint level = f->level;
+
+    for (uint y = 0; y < NP_HEIGHT; y++)
+    {
+        const uint8_t *h = (const uint8_t *)f->heat[y]; // Faixa x = byte x (little-endian).
+        const uint16_t *dst = &np_layout[y * NP_WIDTH];
+
+        for (uint x = 0; x < NP_WIDTH; x++)
+        {
+            // Rampa em três terços: vermelho sobe, depois verde, depois azul.
+            uint t = h[x] * 191u >> 8;
+            uint ramp = (t & 63) << 2;
+            uint r = 255, g = 255, b = ramp;
+            if (t < 128)
+                g = ramp, b = 0;
+            if (t < 64)
+                r = ramp, g = 0;
+            npSetLED(dst[x], (uint8_t)(r * level >> 8), (uint8_t)(g * level >> 8), (uint8_t)(b * level >> 8));
+        }
+    }
+}
+
+/**
+ * Simula, desenha e envia um quadro sem esperar.
+ * Retorna o tempo até o próximo quadro em ms, ou -1 quando acabaram os quadros.
+ */
+int32_t npFireStep(npFire_t *f)
+{
+    if (f->frames && f->frame >= f->frames)
+    {
+        npClear(); // Como NP_ANIM_CLEAR_END: limpa sem enviar.
+        return -1;
+    }
+    f->frame++;
+
+    npFireUpdate(f);
+    npFireRender(f);
+    npWrite();
+    return f->frame_ms;
+}
@@ -0,0 +1,33 @@
+#ifndef NP_FIRE_H
+#define NP_FIRE_H
+
+#include <stdint.h>
+#include "neopixel.h"
+#include "np_layout.h"
+
+// Fogo procedural: grade de calor de 8 bits, quatro células por palavra de
+// 32 bits, atualizada só com inteiros (difusão para cima, resfriamento
+// aleatório e faíscas na base). O calor vira cor por uma rampa preto ->
+// vermelho -> amarelo -> branco.
+
+// Palavras por linha da grade (4 células por palavra).
+#define NP_FIRE_ROW_WORDS ((NP_WIDTH + 3) / 4)
+
+typedef struct
+{
+    uint32_t heat[NP_HEIGHT][NP_FIRE_ROW_WORDS];
+    uint32_t rng;        // Estado do xorshift32.
+    uint32_t cool;       // Máscara do resfriamento aleatório por célula (todas as faixas).
+    uint32_t edge;       // Faixas válidas da última palavra de cada linha.
+    uint8_t level;       // Intensidade máxima da cor (0 a 255).
+    uint16_t frame_ms;   // Intervalo entre quadros.
+    uint32_t frames;     // Quadros a gerar (0 = infinito).
+    uint32_t frame;
+} npFire_t;
+
+void npFireStart(npFire_t *f, uint8_t level, uint16_t frame_ms, uint32_t frames);
+void npFireUpdate(npFire_t *f);
+void npFireRender(const npFire_t *f);
+int32_t npFireStep(npFire_t *f);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef NP_HAL_H
+#define NP_HAL_H
+
+// Camada fina entre o núcleo (framebuffer, animações, escalonador) e o hardware.
+// np_hal_pico.c implementa com o Pico SDK; host/np_hal_host.c simula no Linux
+// (build com NP_HOST definido), gravando os bytes enviados e o tempo virtual.
+
+#ifdef NP_HOST
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+typedef unsigned int uint;
+void panic(const char *fmt, ...);
+#define tight_loop_contents() ((void)0)
+#else
+#include "pico/stdlib.h"
+#endif
+
+// Saída dos LEDs.
+void npHalLedInit(uint pin);
+void npHalLedSend(const void *pixels, uint count);
+void npHalLedSendBlocking(const void *pixels, uint count);
+bool npHalLedIdle(void);
+void npHalLedWait(void);
+void npHalLedSetCallback(void (*callback)(void));
+
+// Relógio.
+uint64_t npHalTimeUs(void);
+void npHalSleepUs(uint64_t us);
+void npHalWaitUntil(uint64_t deadline_us);
+void npHalWake(void);
+
+// Entradas.
+uint32_t npHalGpioGetAll(void);
+
+// Partição da biblioteca de animações (np_library.h). Posições relativas ao
+// início dela; apagar é por setor e gravar por página, alinhados.
+const uint8_t *npHalLibBase(void);
+bool npHalLibErase(uint32_t offset, uint32_t len);
+bool npHalLibProgram(uint32_t offset, const void *data, uint32_t len);
+
+#endif
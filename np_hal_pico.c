@@ -0,0 +1,308 @@
+#include "np_hal.h"
+#include "neopixel.h"
+#include "np_trace.h"
+#include "np_library.h"
+#include "ws2818b.pio.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "pico/flash.h"
+
+// Sinal de RESET do datasheet (linha em nível baixo após o último bit).
+#define NP_RESET_US 100
+
+#if NP_PARALLEL_STRIPS
+#define NP_PROGRAM ws2818b_parallel_program
+#define NP_DMA_SIZE DMA_SIZE_32
+#define NP_DMA_COUNT(n) (6 * (n))
+#elif NP_PACKED_PIXELS
+#define NP_PROGRAM ws2818b_program
+#define NP_PULL_BITS 24
+#define NP_DMA_SIZE DMA_SIZE_32
+#define NP_DMA_COUNT(n) (n)
+#else
+#define NP_PROGRAM ws2818b_program
+#define NP_PULL_BITS 8
+#define NP_DMA_SIZE DMA_SIZE_8
+#define NP_DMA_COUNT(n) (3 * (n))
+#endif
+
+// Variáveis para uso da máquina PIO.
+PIO np_pio;
+uint sm;
+
+// Canal DMA que alimenta a FIFO de TX da máquina PIO.
+static int np_dma_chan;
+static volatile bool np_busy = false;
+static volatile uint64_t np_shift_end_us = 0; // Primeira leitura do TXSTALL no fim do quadro.
+static volatile bool np_shift_latched = true;  // np_shift_end_us já vale para o último envio.
+static void (*np_callback)(void) = NULL;
+static uint16_t np_sent_count; // LEDs do envio em andamento (telemetria).
+
+// Os programas param no `out` com a linha em nível baixo quando a FIFO de TX
+// esvazia: o RESET começa ali, e o PIO marca a parada no bit TXSTALL (fixo até
+// ser limpo) do FDEBUG.
+static inline uint32_t npTxStallMask(void)
+{
+    return 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+}
+
+/**
+ * Limpa o TXSTALL no fim do DMA. A FIFO ainda tem até 8 palavras, então a
+ * próxima parada é a do fim do quadro (e não uma falta de dados no meio dele).
+ */
+static inline void npShiftArm(void)
+{
+    np_shift_latched = false;
+    np_pio->fdebug = npTxStallMask();
+}
+
+/**
+ * Indica se a máquina já deslocou o último bit (TXSTALL depois de npShiftArm).
+ * Na primeira vez que vê o TXSTALL guarda o instante em np_shift_end_us: o
+ * RESET é contado dali, nunca antes da parada real.
+ */
+static inline bool npShiftDone(void)
+{
+    if (!np_shift_latched && (np_pio->fdebug & npTxStallMask()))
+    {
+        np_shift_end_us = time_us_64();
+        np_shift_latched = true;
+    }
+    return np_shift_latched;
+}
+
+#if !NP_DUAL_CORE
+/**
+ * Fim da transferência DMA: libera o buffer enviado; o fim do deslocamento
+ * vem do TXSTALL.
+ */
+static void npDmaIrqHandler(void)
+{
+    if (!dma_channel_get_irq0_status(np_dma_chan))
+        return;
+    dma_channel_acknowledge_irq0(np_dma_chan);
+
+    npShiftArm();
+    np_busy = false;
+    npTrace(NP_EV_FRAME_END, 0, np_sent_count);
+
+    if (np_callback)
+        np_callback();
+}
+#endif
+
+/**
+ * Inicializa a máquina PIO e o canal DMA da matriz de LEDs.
+ */
+void npHalLedInit(uint pin)
+{
+
+    // Toma posse de uma máquina PIO.
+    np_pio = pio0;
+    int claimed = pio_claim_unused_sm(np_pio, false);
+    if (claimed < 0)
+    {
+        np_pio = pio1;
+        claimed = pio_claim_unused_sm(np_pio, true); // Se nenhuma máquina estiver livre, panic!
+    }
+    sm = (uint)claimed;
+
+    // Cria programa PIO, só no bloco da máquina obtida.
+    uint offset = pio_add_program(np_pio, &NP_PROGRAM);
+
+    // Inicia programa na máquina PIO obtida.
+#if NP_PARALLEL_STRIPS
+    (void)pin;
+    ws2818b_parallel_program_init(np_pio, sm, offset, NP_PARALLEL_PIN_BASE, NP_PARALLEL_STRIPS, 800000.f);
+#else
+    ws2818b_program_init(np_pio, sm, offset, pin, 800000.f, NP_PULL_BITS);
+#endif
+
+    // Configura o DMA: buffer de pixels -> FIFO de TX, no ritmo do DREQ da máquina.
+    np_dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(np_dma_chan);
+    channel_config_set_transfer_data_size(&c, NP_DMA_SIZE);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(np_pio, sm, true));
+    dma_channel_configure(np_dma_chan, &c, &np_pio->txf[sm], NULL, 0, false);
+
+#if !NP_DUAL_CORE
+    // No modo dual-core o core1 espera o fim de cada envio por conta própria.
+    dma_channel_set_irq0_enabled(np_dma_chan, true);
+    irq_add_shared_handler(DMA_IRQ_0, npDmaIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+#endif
+}
+
+/**
+ * Inicia o envio de count pixels por DMA e retorna imediatamente.
+ * Na saída paralela count é o número de LEDs por fita.
+ */
+void npHalLedSend(const void *pixels, uint count)
+{
+    np_busy = true;
+    np_sent_count = (uint16_t)count;
+    dma_channel_transfer_from_buffer_now(np_dma_chan, pixels, NP_DMA_COUNT(count));
+}
+
+/**
+ * Envia count pixels e só retorna depois do RESET.
+ */
+void npHalLedSendBlocking(const void *pixels, uint count)
+{
+    dma_channel_transfer_from_buffer_now(np_dma_chan, pixels, NP_DMA_COUNT(count));
+    dma_channel_wait_for_finish_blocking(np_dma_chan);
+    npShiftArm();
+    while (!npShiftDone())
+        tight_loop_contents();
+    busy_wait_until(from_us_since_boot(np_shift_end_us + NP_RESET_US));
+}
+
+/**
+ * Indica se o último envio terminou, incluindo o RESET. Depois do TXSTALL só
+ * resta o que falta do RESET (nada, se a parada foi vista há mais de NP_RESET_US).
+ */
+bool npHalLedIdle(void)
+{
+    return !np_busy && npShiftDone() && time_us_64() >= np_shift_end_us + NP_RESET_US;
+}
+
+/**
+ * Aguarda o fim do envio em andamento.
+ */
+void npHalLedWait(void)
+{
+    while (!npHalLedIdle())
+        tight_loop_contents();
+}
+
+/**
+ * Registra o callback de fim de envio (chamado na interrupção do DMA).
+ */
+void npHalLedSetCallback(void (*callback)(void))
+{
+    np_callback = callback;
+}
+
+uint64_t npHalTimeUs(void)
+{
+    return time_us_64();
+}
+
+void npHalSleepUs(uint64_t us)
+{
+    sleep_us(us);
+}
+
+// Alarme de hardware reservado para os prazos do escalonador (-1 até o primeiro uso).
+static int np_alarm = -1;
+
+/**
+ * A interrupção do alarme já encerra o __wfe; o __sev cobre o caso em que ela
+ * chega entre a programação do alarme e o __wfe.
+ */
+static void npAlarmCallback(uint alarm_num)
+{
+    (void)alarm_num;
+    __sev();
+}
+
+/**
+ * Dorme em __wfe até o prazo absoluto (alarme de hardware) ou até qualquer evento.
+ * Com UINT64_MAX só um evento (interrupção ou __sev) acorda.
+ */
+void npHalWaitUntil(uint64_t deadline_us)
+{
+    if (deadline_us != UINT64_MAX)
+    {
+        if (np_alarm < 0)
+        {
+            np_alarm = hardware_alarm_claim_unused(true);
+            hardware_alarm_set_callback((uint)np_alarm, npAlarmCallback);
+        }
+        // Alarme dedicado: o prazo é comparado direto com o contador do timer.
+        if (hardware_alarm_set_target((uint)np_alarm, from_us_since_boot(deadline_us)))
+            return; // O prazo já passou.
+    }
+    __wfe();
+}
+
+/**
+ * Acorda quem está em npHalWaitUntil (pode ser chamado de interrupções).
+ */
+void npHalWake(void)
+{
+    __sev();
+}
+
+uint32_t npHalGpioGetAll(void)
+{
+    return gpio_get_all();
+}
+
+// Partição da biblioteca: os últimos NP_LIB_SIZE bytes da flash, fora do
+// alcance do UF2 do programa (regravar o firmware não apaga a biblioteca).
+#define NP_LIB_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - NP_LIB_SIZE)
+
+// Operação executada por flash_safe_execute (interrupções desligadas e o
+// core1, no modo dual-core, parado na RAM enquanto a XIP está desligada).
+typedef struct
+{
+    uint32_t offset;
+    const void *data; // NULL: apagar.
+    uint32_t len;
+} npLibFlashOp_t;
+
+static void npLibFlashRun(void *param)
+{
+    const npLibFlashOp_t *op = param;
+
+    if (op->data)
+        flash_range_program(NP_LIB_FLASH_OFFSET + op->offset, op->data, op->len);
+    else
+        flash_range_erase(NP_LIB_FLASH_OFFSET + op->offset, op->len);
+}
+
+/**
+ * Endereço da partição na XIP. Confere uma vez que o programa não invade a
+ * partição (imagem maior que PICO_FLASH_SIZE_BYTES - NP_LIB_SIZE).
+ */
+const uint8_t *npHalLibBase(void)
+{
+    extern char __flash_binary_end;
+
+    if ((uintptr_t)&__flash_binary_end > XIP_BASE + NP_LIB_FLASH_OFFSET)
+        panic("np_library: o programa invade a particao da biblioteca");
+    return (const uint8_t *)(XIP_BASE + NP_LIB_FLASH_OFFSET);
+}
+
+/**
+ * Apaga setores inteiros da partição (cerca de 45ms por setor, com as interrupções desligadas).
+ */
+bool npHalLibErase(uint32_t offset, uint32_t len)
+{
+    npLibFlashOp_t op = {offset, NULL, len};
+
+    if (offset % NP_LIB_SECTOR || len % NP_LIB_SECTOR || len > NP_LIB_SIZE - offset)
+        return false;
+    return flash_safe_execute(npLibFlashRun, &op, 100) == PICO_OK;
+}
+
+/**
+ * Grava páginas inteiras já apagadas. A XIP volta com o cache limpo, então
+ * as leituras seguintes já veem os dados novos.
+ */
+bool npHalLibProgram(uint32_t offset, const void *data, uint32_t len)
+{
+    npLibFlashOp_t op = {offset, data, len};
+
+    if (offset % NP_LIB_PAGE || len % NP_LIB_PAGE || len > NP_LIB_SIZE - offset)
+        return false;
+    return flash_safe_execute(npLibFlashRun, &op, 100) == PICO_OK;
+}
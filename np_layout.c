@@ -0,0 +1,60 @@
+#include "np_layout.h"
+
+// A tabela é gerada pelo pré-processador: cada entrada i é NP_XY da posição
+// i em ordem de varredura. Blocos de 256 entradas entram conforme o tamanho da
+// matriz; as posições que sobram no último bloco valem LED_COUNT (fora da matriz).
+#define NP_LAYOUT_AT(i) \
+    ((i) < NP_LAYOUT_CELLS ? NP_XY((i) % NP_WIDTH, (i) / NP_WIDTH) : LED_COUNT)
+#define NP_LAYOUT_4(i) NP_LAYOUT_AT(i), NP_LAYOUT_AT((i) + 1), NP_LAYOUT_AT((i) + 2), NP_LAYOUT_AT((i) + 3)
+#define NP_LAYOUT_16(i) NP_LAYOUT_4(i), NP_LAYOUT_4((i) + 4), NP_LAYOUT_4((i) + 8), NP_LAYOUT_4((i) + 12)
+#define NP_LAYOUT_64(i) NP_LAYOUT_16(i), NP_LAYOUT_16((i) + 16), NP_LAYOUT_16((i) + 32), NP_LAYOUT_16((i) + 48)
+#define NP_LAYOUT_256(i) NP_LAYOUT_64(i), NP_LAYOUT_64((i) + 64), NP_LAYOUT_64((i) + 128), NP_LAYOUT_64((i) + 192)
+
+const uint16_t np_layout[] = {
+    NP_LAYOUT_256(0),
+#if NP_LAYOUT_CELLS > 256
+    NP_LAYOUT_256(256),
+#endif
+#if NP_LAYOUT_CELLS > 512
+    NP_LAYOUT_256(512),
+#endif
+#if NP_LAYOUT_CELLS > 768
+    NP_LAYOUT_256(768),
+#endif
+#if NP_LAYOUT_CELLS > 1024
+    NP_LAYOUT_256(1024),
+#endif
+#if NP_LAYOUT_CELLS > 1280
+    NP_LAYOUT_256(1280),
+#endif
+#if NP_LAYOUT_CELLS > 1536
+    NP_LAYOUT_256(1536),
+#endif
+#if NP_LAYOUT_CELLS > 1792
+    NP_LAYOUT_256(1792),
+#endif
+#if NP_LAYOUT_CELLS > 2048
+    NP_LAYOUT_256(2048),
+#endif
+#if NP_LAYOUT_CELLS > 2304
+    NP_LAYOUT_256(2304),
+#endif
+#if NP_LAYOUT_CELLS > 2560
+    NP_LAYOUT_256(2560),
+#endif
+#if NP_LAYOUT_CELLS > 2816
+    NP_LAYOUT_256(2816),
+#endif
+#if NP_LAYOUT_CELLS > 3072
+    NP_LAYOUT_256(3072),
+#endif
+#if NP_LAYOUT_CELLS > 3328
+    NP_LAYOUT_256(3328),
+#endif
+#if NP_LAYOUT_CELLS > 3584
+    NP_LAYOUT_256(3584),
+#endif
+#if NP_LAYOUT_CELLS > 3840
+    NP_LAYOUT_256(3840),
+#endif
+};
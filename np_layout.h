@@ -0,0 +1,129 @@
+#ifndef NP_LAYOUT_H
+#define NP_LAYOUT_H
+
+#include "neopixel.h"
+
+// Geometria da matriz: converte coordenadas lógicas (x, y), com (0, 0) no canto
+// inferior esquerdo, para o índice do LED na cadeia. A configuração é toda em
+// tempo de compilação; np_layout.c gera a tabela constante np_layout[] com
+// NP_XY(), e tabelas de animação usam NP_XY() direto nos inicializadores.
+//
+// A matriz física é uma grade de NP_LAYOUT_TILES_X x NP_LAYOUT_TILES_Y painéis
+// de NP_LAYOUT_TILE_W x NP_LAYOUT_TILE_H LEDs, ligados em sequência linha a linha
+// de baixo para cima. Rotação e espelhamento valem para a imagem inteira.
+
+// Tamanho de um painel (padrão: a matriz 5x5 da BitDogLab).
+#ifndef NP_LAYOUT_TILE_W
+#define NP_LAYOUT_TILE_W 5
+#endif
+#ifndef NP_LAYOUT_TILE_H
+#define NP_LAYOUT_TILE_H (LED_COUNT / (NP_LAYOUT_TILE_W * NP_LAYOUT_TILES_X) / NP_LAYOUT_TILES_Y)
+#endif
+
+// Painéis na horizontal e na vertical.
+#ifndef NP_LAYOUT_TILES_X
+#define NP_LAYOUT_TILES_X 1
+#endif
+#ifndef NP_LAYOUT_TILES_Y
+#define NP_LAYOUT_TILES_Y 1
+#endif
+
+// 1: linhas alternam de sentido dentro do painel (zigue-zague); 0: todas da esquerda para a direita.
+#ifndef NP_LAYOUT_SERPENTINE
+#define NP_LAYOUT_SERPENTINE 1
+#endif
+
+// 1: as linhas de painéis também alternam de sentido.
+#ifndef NP_LAYOUT_TILE_SERPENTINE
+#define NP_LAYOUT_TILE_SERPENTINE 0
+#endif
+
+// Rotação da imagem em quartos de volta no sentido horário (0 a 3).
+#ifndef NP_LAYOUT_ROTATION
+#define NP_LAYOUT_ROTATION 0
+#endif
+
+// Espelhamento das coordenadas lógicas, antes da rotação.
+#ifndef NP_LAYOUT_MIRROR_X
+#define NP_LAYOUT_MIRROR_X 0
+#endif
+#ifndef NP_LAYOUT_MIRROR_Y
+#define NP_LAYOUT_MIRROR_Y 0
+#endif
+
+// Tamanho físico e lógico (rotação de 90/270 graus troca largura e altura).
+#define NP_LAYOUT_PW (NP_LAYOUT_TILE_W * NP_LAYOUT_TILES_X)
+#define NP_LAYOUT_PH (NP_LAYOUT_TILE_H * NP_LAYOUT_TILES_Y)
+#define NP_WIDTH (NP_LAYOUT_ROTATION & 1 ? NP_LAYOUT_PH : NP_LAYOUT_PW)
+#define NP_HEIGHT (NP_LAYOUT_ROTATION & 1 ? NP_LAYOUT_PW : NP_LAYOUT_PH)
+#define NP_LAYOUT_CELLS (NP_LAYOUT_PW * NP_LAYOUT_PH)
+
+#if NP_LAYOUT_CELLS > LED_COUNT || NP_LAYOUT_CELLS == 0
+#error "NP_LAYOUT: a grade precisa caber em LED_COUNT"
+#endif
+#if NP_LAYOUT_CELLS > 4096
+#error "NP_LAYOUT: np_layout.c gera no máximo 4096 posições"
+#endif
+
+// Passos da conversão, todos expressões constantes.
+#if NP_LAYOUT_MIRROR_X
+#define NP_LAYOUT_MX(x) (NP_WIDTH - 1 - (x))
+#else
+#define NP_LAYOUT_MX(x) (x)
+#endif
+#if NP_LAYOUT_MIRROR_Y
+#define NP_LAYOUT_MY(y) (NP_HEIGHT - 1 - (y))
+#else
+#define NP_LAYOUT_MY(y) (y)
+#endif
+#if NP_LAYOUT_ROTATION == 0
+#define NP_LAYOUT_ROT(x, y) NP_LAYOUT_PHYS(x, y)
+#elif NP_LAYOUT_ROTATION == 1
+#define NP_LAYOUT_ROT(x, y) NP_LAYOUT_PHYS(NP_LAYOUT_PW - 1 - (y), x)
+#elif NP_LAYOUT_ROTATION == 2
+#define NP_LAYOUT_ROT(x, y) NP_LAYOUT_PHYS(NP_LAYOUT_PW - 1 - (x), NP_LAYOUT_PH - 1 - (y))
+#elif NP_LAYOUT_ROTATION == 3
+#define NP_LAYOUT_ROT(x, y) NP_LAYOUT_PHYS(y, NP_LAYOUT_PH - 1 - (x))
+#else
+#error "NP_LAYOUT_ROTATION: 0 a 3"
+#endif
+// Índice de um ponto físico (px, py): painel, depois linha e coluna dentro dele.
+// NP_LAYOUT_ROW recebe v = coluna + linha * n e dá a coluna, invertida nas linhas ímpares.
+#define NP_LAYOUT_ROW(v, n, serp) ((serp) && ((v) / (n)) % 2 ? (n) - 1 - (v) % (n) : (v) % (n))
+#define NP_LAYOUT_TILE(px, py) \
+    ((py) / NP_LAYOUT_TILE_H * NP_LAYOUT_TILES_X + NP_LAYOUT_ROW((px) / NP_LAYOUT_TILE_W + (py) / NP_LAYOUT_TILE_H * NP_LAYOUT_TILES_X, NP_LAYOUT_TILES_X, NP_LAYOUT_TILE_SERPENTINE))
+#define NP_LAYOUT_PHYS(px, py)                                               \
+    (NP_LAYOUT_TILE(px, py) * (NP_LAYOUT_TILE_W * NP_LAYOUT_TILE_H) +        \
+     (py) % NP_LAYOUT_TILE_H * NP_LAYOUT_TILE_W +                            \
+     NP_LAYOUT_ROW((px) % NP_LAYOUT_TILE_W + (py) % NP_LAYOUT_TILE_H * NP_LAYOUT_TILE_W, NP_LAYOUT_TILE_W, NP_LAYOUT_SERPENTINE))
+
+/**
+ * Índice do LED em (x, y) como expressão constante (para tabelas em flash).
+ * Sem verificação de limites; em tempo de execução use np_layout[] ou npSetXY().
+ */
+#define NP_XY(x, y) NP_LAYOUT_ROT(NP_LAYOUT_MX(x), NP_LAYOUT_MY(y))
+
+// Tabela (x, y) -> índice, em ordem de varredura: np_layout[y * NP_WIDTH + x].
+extern const uint16_t np_layout[];
+
+/**
+ * Índice do LED em (x, y); fora da matriz retorna LED_COUNT.
+ */
+static inline uint npLayoutIndex(int x, int y)
+{
+    if ((uint)x >= (uint)NP_WIDTH || (uint)y >= (uint)NP_HEIGHT)
+        return LED_COUNT;
+    return np_layout[y * NP_WIDTH + x];
+}
+
+/**
+ * Atribui uma cor ao LED em (x, y), ignorando pontos fora da matriz.
+ */
+static inline void npSetXY(int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+    uint i = npLayoutIndex(x, y);
+    if (i < LED_COUNT)
+        npSetLED(i, r, g, b);
+}
+
+#endif
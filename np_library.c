@@ -0,0 +1,277 @@
+#include <string.h>
+#include "np_library.h"
+#include "np_layout.h"
+
+/**
+ * Confere a imagem na partição (cabeçalho, CRC, limites de cada entrada e o
+ * fluxo de cada uma com npDeltaValidate) e abre a biblioteca. O CRC só prova
+ * que a imagem chegou inteira; quem a gerou pode ter errado, e o decodificador
+ * confia no fluxo. Tudo é lido uma vez pela XIP aqui; depois disso as entradas
+ * são usadas sem novas verificações.
+ */
+bool npLibOpen(npLib_t *lib)
+{
+    const npLibHeader_t *h = (const npLibHeader_t *)npHalLibBase();
+
+    lib->hdr = NULL;
+    if (h->magic != NP_LIB_MAGIC || h->version != NP_LIB_VERSION || h->size < sizeof(*h) || h->size > NP_LIB_SIZE)
+        return false;
+    if (h->width != NP_WIDTH || h->height != NP_HEIGHT)
+        return false;
+    if (npLibCrc32(0, (const uint8_t *)h + NP_LIB_CRC_START, h->size - NP_LIB_CRC_START) != h->crc)
+        return false;
+
+    for (uint k = 0; k < NP_LIB_KEYS; k++)
+    {
+        const npLibEntry_t *e = &h->dir[k];
+        if (e->palette == 0)
+            continue;
+        if (e->palette > h->size || e->colors == 0 || 3u * e->colors > h->size - e->palette)
+            return false;
+        if (e->data > h->size || e->size > h->size - e->data || e->frame_count == 0 || e->loops == 0)
+            return false;
+        if (memchr(e->name, '\0', sizeof(e->name)) == NULL)
+            return false;
+    }
+
+    lib->hdr = h;
+    for (uint k = 0; k < NP_LIB_KEYS; k++)
+    {
+        npDeltaAnim_t anim;
+        if (npLibGetAnim(lib, k, &anim) && !npDeltaValidate(&anim))
+        {
+            lib->hdr = NULL;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Esquece a biblioteca (antes de regravar a partição).
+ */
+void npLibClose(npLib_t *lib)
+{
+    lib->hdr = NULL;
+}
+
+/**
+ * Entrada da tecla (índice de npLibKeyIndex), ou NULL sem biblioteca ou com a tecla livre.
+ */
+const npLibEntry_t *npLibFind(const npLib_t *lib, uint key)
+{
+    if (!lib->hdr || key >= NP_LIB_KEYS || lib->hdr->dir[key].palette == 0)
+        return NULL;
+    return &lib->hdr->dir[key];
+}
+
+/**
+ * Monta em anim a animação da tecla, com paleta e quadros apontando para a
+ * partição (XIP). anim precisa durar enquanto o decodificador a usa.
+ */
+bool npLibGetAnim(const npLib_t *lib, uint key, npDeltaAnim_t *anim)
+{
+    const npLibEntry_t *e = npLibFind(lib, key);
+    const uint8_t *base = (const uint8_t *)lib->hdr;
+
+    if (!e)
+        return false;
+    anim->palette = (const npColor_t *)(base + e->palette);
+    anim->colors = e->colors;
+    anim->data = base + e->data;
+    anim->size = e->size;
+    anim->frame_count = e->frame_count;
+    anim->loops = e->loops;
+    anim->flags = e->flags;
+    return true;
+}
+
+static uint32_t npLibLe32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * Responde ao host ('A'): estado e bytes gravados até aqui.
+ */
+static void npLibAck(npLibUpload_t *u, uint8_t status)
+{
+    uint8_t p[5 + 5 + 1] = {NP_STREAM_MAGIC0, NP_STREAM_MAGIC1, NP_LIB_ACK, 5, 0, status};
+    uint8_t sum = status;
+
+    for (uint i = 0; i < 4; i++)
+    {
+        p[6 + i] = (uint8_t)(u->next >> (8 * i));
+        sum ^= p[6 + i];
+    }
+    p[sizeof(p) - 1] = sum;
+    u->write(p, sizeof(p));
+}
+
+/**
+ * Entra no modo de recepção. A biblioteca atual continua valendo até o 'U'.
+ */
+void npLibUploadStart(npLibUpload_t *u, npLib_t *lib, npStreamRead_t read, npStreamWrite_t write)
+{
+    memset(u, 0, sizeof(*u));
+    u->read = read;
+    u->write = write;
+    u->lib = lib;
+    u->active = true;
+    u->last_rx_us = npHalTimeUs();
+    npLibAck(u, NP_LIB_OK); // Avisa o host que já pode enviar.
+}
+
+bool npLibUploadActive(const npLibUpload_t *u)
+{
+    return u->active;
+}
+
+/**
+ * Sai do modo de recepção. Sem o 'F' a partição pode ter ficado pela metade:
+ * npLibOpen decide se ainda há uma biblioteca válida.
+ */
+static void npLibUploadEnd(npLibUpload_t *u, bool finished)
+{
+    u->active = false;
+    if (!finished)
+        npLibOpen(u->lib);
+}
+
+/**
+ * Tipo conhecido com tamanho possível. Como em np_stream.c, evita que um 'N' 'P'
+ * qualquer vire um cabeçalho durante a procura.
+ */
+static bool npLibHeaderOk(const uint8_t *h)
+{
+    uint len = h[3] | h[4] << 8;
+
+    switch (h[2])
+    {
+    case NP_LIB_BEGIN:
+        return len == 4;
+    case NP_LIB_WRITE:
+        return len > 4 && len <= 4 + NP_LIB_PAGE;
+    case NP_LIB_FINISH:
+    case NP_STREAM_EXIT:
+        return len == 0;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Grava um trecho de 'W' numa página (apagando o setor quando ela é a primeira
+ * dele). Só a última página pode vir incompleta; o resto dela fica em 0xFF.
+ */
+static uint8_t npLibWritePage(npLibUpload_t *u, uint32_t offset, uint8_t *data, uint n)
+{
+    if (!u->started || offset != u->next || n > u->size - offset || (n < NP_LIB_PAGE && offset + n != u->size))
+        return NP_LIB_ERR_ORDER;
+    if (offset % NP_LIB_SECTOR == 0 && !npHalLibErase(offset, NP_LIB_SECTOR))
+        return NP_LIB_ERR_FLASH;
+    memset(data + n, 0xFF, NP_LIB_PAGE - n);
+    if (!npHalLibProgram(offset, data, NP_LIB_PAGE))
+        return NP_LIB_ERR_FLASH;
+    u->next += n;
+    return NP_LIB_OK;
+}
+
+/**
+ * Pacote completo em hdr e payload: confere o XOR, executa e responde.
+ */
+static void npLibPacket(npLibUpload_t *u)
+{
+    uint8_t *p = u->payload;
+    uint8_t sum = 0, status = NP_LIB_OK;
+    bool finished = false;
+
+    for (uint i = 0; i < u->len; i++)
+        sum ^= p[i];
+    if (sum != p[u->len])
+    {
+        npLibAck(u, NP_LIB_ERR_PACKET);
+        return;
+    }
+
+    switch (u->hdr[2])
+    {
+    case NP_LIB_BEGIN:
+    {
+        uint32_t size = npLibLe32(p);
+        if (size < sizeof(npLibHeader_t) || size > NP_LIB_SIZE)
+        {
+            status = NP_LIB_ERR_SIZE;
+            break;
+        }
+        npLibClose(u->lib); // A partição vai ser regravada.
+        u->size = size;
+        u->next = 0;
+        u->started = true;
+        break;
+    }
+    case NP_LIB_WRITE:
+        status = npLibWritePage(u, npLibLe32(p), p + 4, u->len - 4u);
+        break;
+    case NP_LIB_FINISH:
+        if (!u->started || u->next != u->size)
+            status = NP_LIB_ERR_ORDER;
+        else if (!npLibOpen(u->lib) || u->lib->hdr->size != u->size)
+        {
+            npLibClose(u->lib);
+            status = NP_LIB_ERR_IMAGE;
+        }
+        else
+            finished = true;
+        break;
+    default: // NP_STREAM_EXIT
+        npLibUploadEnd(u, false);
+        break;
+    }
+
+    npLibAck(u, status);
+    if (finished)
+        npLibUploadEnd(u, true);
+}
+
+/**
+ * Lê o que chegou e executa os pacotes completos (gravar na flash bloqueia
+ * durante o apagamento do setor). Retorna o tempo até a próxima leitura em us,
+ * ou -1 quando a recepção terminou.
+ */
+int32_t npLibUploadStep(npLibUpload_t *u)
+{
+    uint64_t now = npHalTimeUs();
+
+    while (u->active)
+    {
+        uint8_t *dst = u->got < 5 ? &u->hdr[u->got] : &u->payload[u->got - 5];
+        uint want = u->got < 5 ? 5u - u->got : 5u + u->len + 1 - u->got;
+        int n = u->read(dst, want);
+        if (n < 0)
+            npLibUploadEnd(u, false);
+        if (n <= 0)
+            break;
+        u->got += (uint16_t)n;
+        u->last_rx_us = now;
+
+        if (u->got <= 5)
+        {
+            // Fora de sincronia: procura o próximo cabeçalho.
+            while (u->got && (u->hdr[0] != NP_STREAM_MAGIC0 || (u->got > 1 && u->hdr[1] != NP_STREAM_MAGIC1) ||
+                              (u->got == 5 && !npLibHeaderOk(u->hdr))))
+                memmove(u->hdr, u->hdr + 1, --u->got);
+            if (u->got == 5)
+                u->len = (uint16_t)(u->hdr[3] | u->hdr[4] << 8);
+        }
+        else if (u->got == 5 + u->len + 1)
+        {
+            u->got = 0;
+            npLibPacket(u);
+        }
+    }
+
+    if (u->active && now - u->last_rx_us > NP_LIB_TIMEOUT_US)
+        npLibUploadEnd(u, false);
+    return u->active ? NP_LIB_POLL_US : -1;
+}
@@ -0,0 +1,157 @@
+#ifndef NP_LIBRARY_H
+#define NP_LIBRARY_H
+
+#include <string.h>
+#include "np_delta.h"
+#include "np_stream.h"
+
+// Biblioteca de animações numa partição reservada no fim da flash, fora da
+// imagem do programa: trocar as animações não exige regravar o firmware.
+//
+// A imagem começa com npLibHeader_t, cujo diretório tem uma entrada por tecla
+// (posição em NP_LIB_KEY_CHARS), então achar a animação de uma tecla é um
+// acesso direto. Cada entrada aponta para uma paleta e um fluxo np_delta
+// dentro da imagem; npDeltaStep lê os quadros direto pela XIP, sem cópia em RAM.
+// Todos os números são little-endian e os campos ficam alinhados (o M0+ não
+// lê palavras desalinhadas).
+//
+// Gerador da imagem: host/np_assetc.c (-b). Envio pela USB: host/np_stream_send.c (-u).
+
+// Tamanho da partição (múltiplo do setor) e granularidade da flash.
+#ifndef NP_LIB_SIZE
+#define NP_LIB_SIZE (256 * 1024)
+#endif
+#define NP_LIB_SECTOR 4096
+#define NP_LIB_PAGE 256
+
+#define NP_LIB_MAGIC 0x424C504Eu // "NPLB"
+#define NP_LIB_VERSION 1
+
+// Teclas na ordem do diretório (mesma ordem do mapa do teclado).
+#define NP_LIB_KEY_CHARS "123A456B789C*0#D"
+#define NP_LIB_KEYS 16
+
+// Comandos do laço principal: tecla que escolhe uma animação da biblioteca
+// (a próxima tecla diz qual) e caractere da serial que recebe uma biblioteca nova.
+#define NP_LIB_CMD '4'
+#define NP_LIB_UPLOAD_CMD 'U'
+
+typedef struct
+{
+    uint32_t palette;     // Posição da paleta na imagem (npColor_t, 3 bytes por cor); 0 = tecla livre.
+    uint32_t data;        // Posição do fluxo np_delta.
+    uint32_t size;        // Bytes do fluxo.
+    uint16_t frame_count;
+    uint16_t colors;      // Cores na paleta.
+    uint8_t loops;
+    uint8_t flags;        // NP_ANIM_CLEAR_END
+    char name[14];        // Terminado em '\0'.
+} npLibEntry_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;   // Entradas ocupadas no diretório.
+    uint32_t size;    // Bytes da imagem, cabeçalho incluído.
+    uint32_t crc;     // npLibCrc32 dos bytes de width até o fim da imagem.
+    uint16_t width;   // Grade para a qual os fluxos foram gerados (NP_WIDTH x NP_HEIGHT).
+    uint16_t height;
+    uint32_t reserved;
+    npLibEntry_t dir[NP_LIB_KEYS];
+} npLibHeader_t;
+
+// Parte da imagem coberta pelo CRC.
+#define NP_LIB_CRC_START 16
+
+typedef struct
+{
+    const npLibHeader_t *hdr; // NULL: nenhuma biblioteca válida na partição.
+} npLib_t;
+
+// npLibKeyIndex e npLibCrc32 são inline para o gerador da imagem
+// (host/np_assetc.c) usar as mesmas regras sem ligar com o firmware.
+
+/**
+ * Posição da tecla no diretório, ou -1 se ela não tem entrada.
+ */
+static inline int npLibKeyIndex(char key)
+{
+    const char *p = key ? strchr(NP_LIB_KEY_CHARS, key) : NULL;
+    return p ? (int)(p - NP_LIB_KEY_CHARS) : -1;
+}
+
+/**
+ * CRC-32 (polinômio refletido 0xEDB88320), meio byte por vez.
+ */
+static inline uint32_t npLibCrc32(uint32_t crc, const void *buf, uint32_t len)
+{
+    static const uint32_t t[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+    const uint8_t *p = buf;
+
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ t[crc & 15];
+        crc = (crc >> 4) ^ t[crc & 15];
+    }
+    return ~crc;
+}
+
+bool npLibOpen(npLib_t *lib);
+void npLibClose(npLib_t *lib);
+const npLibEntry_t *npLibFind(const npLib_t *lib, uint key);
+bool npLibGetAnim(const npLib_t *lib, uint key, npDeltaAnim_t *anim);
+
+// Recepção de uma biblioteca nova, com o enquadramento de np_stream.h:
+//   'U' tamanho(32 bits)            começa (a biblioteca atual deixa de valer)
+//   'W' posição(32 bits) bytes...   até NP_LIB_PAGE bytes, em ordem, a partir de posições múltiplas da página
+//   'F'                             fim: confere a imagem e abre a biblioteca
+//   'X'                             desiste
+//   'A' estado posição(32 bits)     (placa -> host) resposta a cada pacote: estado e bytes aceitos
+// O host espera o 'A' de cada pacote antes de mandar o próximo (apagar um setor
+// leva dezenas de ms, com a USB segurando o host nesse tempo).
+#define NP_LIB_BEGIN 'U'
+#define NP_LIB_WRITE 'W'
+#define NP_LIB_FINISH 'F'
+#define NP_LIB_ACK 'A'
+
+// Estado no 'A'.
+enum
+{
+    NP_LIB_OK,
+    NP_LIB_ERR_PACKET, // Pacote corrompido ou desconhecido: o host reenvia.
+    NP_LIB_ERR_SIZE,   // Tamanho maior que a partição.
+    NP_LIB_ERR_ORDER,  // 'W' fora de ordem: o host continua da posição do 'A'.
+    NP_LIB_ERR_FLASH,  // Falha ao apagar ou gravar a flash.
+    NP_LIB_ERR_IMAGE,  // A imagem gravada não passou em npLibOpen.
+};
+
+// Período de leitura da USB e tempo sem bytes até desistir.
+#define NP_LIB_POLL_US 1000
+#define NP_LIB_TIMEOUT_US 3000000
+
+typedef struct
+{
+    npStreamRead_t read;
+    npStreamWrite_t write;
+    npLib_t *lib;          // Fechada no início e reaberta no 'F'.
+    uint64_t last_rx_us;
+    uint32_t size;         // Anunciado no 'U'.
+    uint32_t next;         // Bytes já gravados.
+    uint16_t len;          // Payload do pacote em andamento.
+    uint16_t got;          // Bytes recebidos do pacote (cabeçalho, payload e XOR).
+    uint8_t hdr[5];
+    uint8_t payload[4 + NP_LIB_PAGE + 1]; // Payload e XOR.
+    bool started;          // Já recebeu o 'U'.
+    bool active;
+} npLibUpload_t;
+
+void npLibUploadStart(npLibUpload_t *u, npLib_t *lib, npStreamRead_t read, npStreamWrite_t write);
+int32_t npLibUploadStep(npLibUpload_t *u);
+bool npLibUploadActive(const npLibUpload_t *u);
+
+#endif
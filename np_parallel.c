@@ -0,0 +1,54 @@
+#include "np_parallel.h"
+
+/**
+ * Transpõe uma matriz de 8x8 bits: linha s = byte da fita s; sai o byte do
+ * tempo de bit k (bit s = bit k da fita s) nas posições 0..7 de lo/hi
+ * (palavras little-endian, prontas para a FIFO). Hacker's Delight, transpose8.
+ */
+static inline void npTranspose8(uint32_t x, uint32_t y, uint32_t *out)
+{
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;
+    y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC;
+    y = y ^ t ^ (t << 14);
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    out[0] = y;
+    out[1] = t;
+}
+
+/**
+ * Monta o fluxo de planos de bits de strips fitas de len LEDs (strips <= 8).
+ * Cada canal passa pela tabela de saída lut (NULL = sem correção). Mesma ordem
+ * do envio serial: G, R, B, cada byte começando pelo bit 0.
+ */
+void npParallelPack(uint32_t *planes, const npLED_t *pixels, uint strips, uint len, const uint8_t *lut)
+{
+    for (uint i = 0; i < len; i++)
+    {
+        uint8_t g[8] = {0}, r[8] = {0}, b[8] = {0};
+
+        for (uint s = 0; s < strips; s++)
+        {
+            const npLED_t *p = &pixels[s * len + i];
+            g[s] = lut ? lut[p->G] : p->G;
+            r[s] = lut ? lut[p->R] : p->R;
+            b[s] = lut ? lut[p->B] : p->B;
+        }
+
+#define NP_ROWS_HI(a) ((uint32_t)a[7] << 24 | (uint32_t)a[6] << 16 | (uint32_t)a[5] << 8 | a[4])
+#define NP_ROWS_LO(a) ((uint32_t)a[3] << 24 | (uint32_t)a[2] << 16 | (uint32_t)a[1] << 8 | a[0])
+        npTranspose8(NP_ROWS_HI(g), NP_ROWS_LO(g), &planes[0]);
+        npTranspose8(NP_ROWS_HI(r), NP_ROWS_LO(r), &planes[2]);
+        npTranspose8(NP_ROWS_HI(b), NP_ROWS_LO(b), &planes[4]);
+#undef NP_ROWS_HI
+#undef NP_ROWS_LO
+        planes += 6;
+    }
+}
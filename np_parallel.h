@@ -0,0 +1,18 @@
+#ifndef NP_PARALLEL_H
+#define NP_PARALLEL_H
+
+#include "neopixel.h"
+
+// Saída paralela (NP_PARALLEL_STRIPS > 0): leds[] é a concatenação das fitas,
+// fita s = leds[s * NP_STRIP_LEN .. (s + 1) * NP_STRIP_LEN). O programa
+// ws2818b_parallel recebe um byte por tempo de bit (bit s = fita s), 24 bytes
+// (6 palavras) por posição de LED.
+
+#if NP_PARALLEL_STRIPS
+#define NP_STRIP_LEN (LED_COUNT / NP_PARALLEL_STRIPS)
+#define NP_PARALLEL_WORDS (6 * NP_STRIP_LEN)
+#endif
+
+void npParallelPack(uint32_t *planes, const npLED_t *pixels, uint strips, uint len, const uint8_t *lut);
+
+#endif
@@ -0,0 +1,126 @@
+#include <string.h>
+#include "np_ring.h"
+#include "neopixel.h"
+#include "np_trace.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+// Anel de quadros: produtor único (core0) e consumidor único (core1).
+// head é o quadro sendo desenhado (só o core0 escreve); tail é o quadro mais
+// antigo ainda não liberado pelo core1 (só o core1 escreve). Os índices dos
+// quadros prontos viajam pela FIFO do SIO, que também acorda o core1.
+static npLED_t ring[NP_RING_FRAMES][LED_COUNT];
+static volatile uint head = 0;
+static volatile uint tail = 0;
+
+static volatile uint32_t period_us = 0; // 0: envia assim que o quadro chega.
+static volatile npRingStats_t stats;
+
+/**
+ * Laço do core1: recebe quadros prontos e cuida do envio e do RESET.
+ */
+static void npRingCore1(void)
+{
+    uint64_t next_tick = 0;
+
+    // Deixa o core0 parar este core na RAM enquanto grava a biblioteca na flash.
+    multicore_lockout_victim_init();
+
+    while (true)
+    {
+        uint32_t slot = multicore_fifo_pop_blocking();
+
+        // Com FPS alvo, cada quadro sai numa fronteira de período; quadro que
+        // chega depois da sua fronteira conta como atrasado.
+        uint32_t period = period_us;
+        if (period)
+        {
+            uint64_t now = time_us_64();
+            if (next_tick == 0 || now > next_tick + period)
+            {
+                if (next_tick != 0)
+                {
+                    stats.late++;
+                    npTrace(NP_EV_RING_LATE, 0, (uint16_t)stats.late);
+                }
+                next_tick = now;
+            }
+            while (time_us_64() < next_tick)
+                tight_loop_contents();
+            next_tick += period;
+        }
+
+        npTrace(NP_EV_FRAME_START, (uint8_t)slot, (uint16_t)stats.displayed);
+        npTransmitBlocking(ring[slot]);
+        npTrace(NP_EV_FRAME_END, (uint8_t)slot, LED_COUNT);
+        stats.displayed++;
+
+        // Libera o quadro para o produtor.
+        __dmb();
+        tail = (slot + 1) % NP_RING_FRAMES;
+    }
+}
+
+/**
+ * Prepara o anel e entrega a saída dos LEDs ao core1.
+ */
+void npRingInit(void)
+{
+    memset(ring, 0, sizeof(ring));
+    head = tail = 0;
+    leds = ring[0];
+    multicore_launch_core1(npRingCore1);
+}
+
+/**
+ * Indica se há espaço para publicar um quadro sem descartá-lo.
+ */
+bool npRingReady(void)
+{
+    return (head + 1) % NP_RING_FRAMES != tail;
+}
+
+/**
+ * Publica o quadro desenhado em leds[] e passa a desenhar no próximo quadro livre.
+ * Nunca bloqueia: com o anel cheio o quadro é descartado e o desenho continua no mesmo buffer.
+ */
+bool npRingPublish(void)
+{
+    if (!npRingReady())
+    {
+        stats.dropped++;
+        npTrace(NP_EV_RING_DROP, 0, (uint16_t)stats.dropped);
+        return false;
+    }
+
+    uint next = (head + 1) % NP_RING_FRAMES;
+
+    // As animações desenham de forma incremental, então o próximo quadro parte do atual.
+    memcpy(ring[next], ring[head], sizeof(ring[0]));
+
+    __dmb();
+    multicore_fifo_push_blocking(head);
+    head = next;
+    leds = ring[next];
+    stats.published++;
+    return true;
+}
+
+/**
+ * Define o FPS alvo do core1 (0 desativa o ritmo fixo).
+ */
+void npRingSetTargetFps(uint fps)
+{
+    period_us = fps ? 1000000 / fps : 0;
+}
+
+/**
+ * Copia os contadores de quadros publicados, enviados, descartados e atrasados.
+ */
+void npRingGetStats(npRingStats_t *out)
+{
+    out->published = stats.published;
+    out->displayed = stats.displayed;
+    out->dropped = stats.dropped;
+    out->late = stats.late;
+}
@@ -0,0 +1,24 @@
+#ifndef NP_RING_H
+#define NP_RING_H
+
+#include "pico/stdlib.h"
+
+// Número de quadros no anel entre o core0 (desenho) e o core1 (transmissão).
+// Um deles está sempre sendo desenhado pelo core0.
+#define NP_RING_FRAMES 4
+
+typedef struct
+{
+    uint32_t published; // Quadros entregues pelo core0.
+    uint32_t displayed; // Quadros enviados aos LEDs pelo core1.
+    uint32_t dropped;   // Quadros descartados porque o anel estava cheio.
+    uint32_t late;      // Períodos em que o core1 não tinha quadro novo a tempo.
+} npRingStats_t;
+
+void npRingInit(void);
+bool npRingReady(void);
+bool npRingPublish(void);
+void npRingSetTargetFps(uint fps);
+void npRingGetStats(npRingStats_t *stats);
+
+#endif
@@ -0,0 +1,144 @@
+#include <string.h>
+#include "np_sched.h"
+#include "np_trace.h"
+
+static npTask_t *tasks[NP_SCHED_MAX_TASKS];
+
+/**
+ * Inicia (ou reinicia) uma tarefa; o primeiro passo roda no próximo npSchedRun().
+ * A política volta a NP_SCHED_CATCHUP e o histograma de atraso é zerado.
+ */
+void npSchedStart(npTask_t *task, npTaskStep_t step, void *ctx)
+{
+    task->step = step;
+    task->ctx = ctx;
+    task->deadline_us = npHalTimeUs();
+    task->active = true;
+    task->policy = NP_SCHED_CATCHUP;
+    memset(&task->late, 0, sizeof(task->late));
+
+    for (uint i = 0; i < NP_SCHED_MAX_TASKS; ++i)
+        if (tasks[i] == task)
+            return;
+
+    for (uint i = 0; i < NP_SCHED_MAX_TASKS; ++i)
+    {
+        if (tasks[i] == NULL || !tasks[i]->active)
+        {
+            tasks[i] = task;
+            return;
+        }
+    }
+    panic("npSched: sem espaço para tarefas");
+}
+
+/**
+ * Interrompe uma tarefa; ela deixa de receber passos.
+ */
+void npSchedStop(npTask_t *task)
+{
+    task->active = false;
+}
+
+/**
+ * Define o que fazer com prazos perdidos (depois de npSchedStart).
+ */
+void npSchedSetPolicy(npTask_t *task, npSchedPolicy_t policy)
+{
+    task->policy = (uint8_t)policy;
+}
+
+/**
+ * Copia as estatísticas de atraso da tarefa.
+ */
+void npSchedGetLate(const npTask_t *task, npSchedLate_t *out)
+{
+    *out = task->late;
+}
+
+/**
+ * Registra o atraso de um passo no histograma.
+ */
+static void npSchedRecordLate(npSchedLate_t *l, uint64_t late_us)
+{
+    uint32_t us = late_us > UINT32_MAX ? UINT32_MAX : (uint32_t)late_us;
+    uint bin = 0;
+
+    if (us >= 8)
+    {
+        bin = 31 - __builtin_clz(us) - 2;
+        if (bin >= NP_SCHED_LATE_BINS)
+            bin = NP_SCHED_LATE_BINS - 1;
+    }
+    if (l->hist[bin] < UINT16_MAX)
+        l->hist[bin]++;
+    if (us > l->max_us)
+        l->max_us = us;
+    l->sum_us += us;
+    l->steps++;
+}
+
+/**
+ * Indica se a tarefa ainda está em execução.
+ */
+bool npSchedActive(const npTask_t *task)
+{
+    return task->active;
+}
+
+/**
+ * Executa os passos vencidos e dorme (__wfe) até o próximo prazo ou até um evento.
+ * Retorna depois de cada despertar para que o laço principal trate comandos.
+ */
+void npSchedRun(void)
+{
+    uint64_t now = npHalTimeUs();
+    uint64_t next = UINT64_MAX;
+
+    for (uint i = 0; i < NP_SCHED_MAX_TASKS; ++i)
+    {
+        npTask_t *t = tasks[i];
+        if (t == NULL || !t->active)
+            continue;
+
+        if (now >= t->deadline_us)
+        {
+            npSchedRecordLate(&t->late, now - t->deadline_us);
+            int32_t delay = t->step(t->ctx);
+            uint64_t t1 = npHalTimeUs();
+            npTrace(NP_EV_TASK, (uint8_t)i, (uint16_t)(t1 - now));
+            now = t1;
+            if (delay < 0)
+            {
+                t->active = false;
+                continue;
+            }
+            // Prazos absolutos: o tempo gasto no passo não acumula atraso.
+            t->deadline_us += delay;
+            if (t->policy == NP_SCHED_DROP && t->deadline_us < now && delay > 0)
+            {
+                // Pula os prazos que já passaram, mantendo a fase da grade.
+                uint64_t missed = (now - t->deadline_us + (uint32_t)delay - 1) / (uint32_t)delay;
+                t->deadline_us += missed * (uint32_t)delay;
+                t->late.dropped += (uint32_t)missed;
+            }
+        }
+
+        if (t->deadline_us < next)
+            next = t->deadline_us;
+    }
+
+    if (next <= now)
+        return;
+
+    // O alarme do timer (ou qualquer interrupção) gera o evento que encerra o __wfe.
+    npHalWaitUntil(next);
+}
+
+/**
+ * Acorda o laço principal a partir de uma interrupção.
+ */
+void npSchedWake(void)
+{
+    npHalWake();
+}
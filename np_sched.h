@@ -0,0 +1,54 @@
+#ifndef NP_SCHED_H
+#define NP_SCHED_H
+
+#include "np_hal.h"
+
+// Número máximo de tarefas registradas ao mesmo tempo.
+#define NP_SCHED_MAX_TASKS 4
+
+// Valor de retorno de um passo que encerra a tarefa.
+#define NP_TASK_DONE (-1)
+
+// Executa um passo da tarefa e retorna o atraso em us até o próximo passo,
+// ou NP_TASK_DONE quando terminou. Não deve bloquear.
+typedef int32_t (*npTaskStep_t)(void *ctx);
+
+// O que fazer quando um passo termina depois do prazo do passo seguinte.
+typedef enum
+{
+    NP_SCHED_CATCHUP, // Roda os passos atrasados em seguida: o número de passos por segundo é exato.
+    NP_SCHED_DROP,    // Pula os prazos perdidos e volta à grade: nunca há rajadas de passos.
+} npSchedPolicy_t;
+
+// Histograma de atraso (início do passo - prazo): a classe 0 vai até 7us e a
+// classe k > 0 conta atrasos em [2^(k+2), 2^(k+3)) us; a última não tem limite.
+#define NP_SCHED_LATE_BINS 12
+
+typedef struct
+{
+    uint32_t steps;
+    uint32_t dropped; // Prazos pulados (NP_SCHED_DROP).
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint16_t hist[NP_SCHED_LATE_BINS];
+} npSchedLate_t;
+
+typedef struct
+{
+    npTaskStep_t step;
+    void *ctx;
+    uint64_t deadline_us; // Instante absoluto do próximo passo.
+    bool active;
+    uint8_t policy; // npSchedPolicy_t
+    npSchedLate_t late;
+} npTask_t;
+
+void npSchedStart(npTask_t *task, npTaskStep_t step, void *ctx);
+void npSchedStop(npTask_t *task);
+void npSchedSetPolicy(npTask_t *task, npSchedPolicy_t policy);
+void npSchedGetLate(const npTask_t *task, npSchedLate_t *out);
+bool npSchedActive(const npTask_t *task);
+void npSchedRun(void);
+void npSchedWake(void);
+
+#endif
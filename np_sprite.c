@@ -0,0 +1,62 @@
+#include "np_sprite.h"
+#include "np_layout.h"
+
+/**
+ * Pinta os pixels acesos do sprite com o canto inferior esquerdo em (x, y);
+ * os apagados ficam como estão. Partes fora da matriz são recortadas.
+ */
+void npBlit(const npSprite_t *s, int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+    const int w = s->w;
+    uint32_t bits = s->bits;
+
+    if (bits == 0 || x >= NP_WIDTH || y >= NP_HEIGHT || x + w <= 0 || y + s->h <= 0)
+        return;
+
+    // Recorte horizontal: uma máscara de colunas serve para todas as linhas.
+    uint32_t clip = w >= 32 ? ~0u : (1u << w) - 1;
+    if (x < 0)
+        clip &= ~((1u << -x) - 1);
+    if (x + w > NP_WIDTH)
+        clip &= (1u << (NP_WIDTH - x)) - 1;
+
+    // Recorte vertical: descarta as linhas de baixo de uma vez e limita as de cima.
+    int sy = 0, h = s->h;
+    if (y < 0)
+    {
+        sy = -y;
+        bits >>= sy * w;
+    }
+    if (y + h > NP_HEIGHT)
+        h = NP_HEIGHT - y;
+
+    // Uma linha por vez; linhas vazias custam um deslocamento e uma comparação.
+    for (; sy < h && bits; sy++)
+    {
+        uint32_t row = bits & clip;
+        int base = (y + sy) * NP_WIDTH + x;
+        while (row)
+        {
+            npSetLED(np_layout[base + __builtin_ctz(row)], r, g, b);
+            row &= row - 1;
+        }
+        bits = w < 32 ? bits >> w : 0;
+    }
+}
+
+/**
+ * Desenha vários planos sobrepostos, o plano k na cor palette[k] (os últimos por cima).
+ */
+void npBlitPalette(const npSprite_t *planes, uint count, const npColor_t *palette, int x, int y)
+{
+    for (uint k = 0; k < count; k++)
+        npBlit(&planes[k], x, y, palette[k].r, palette[k].g, palette[k].b);
+}
+
+/**
+ * Apaga os pixels acesos do sprite (para mover sem limpar a matriz inteira).
+ */
+void npBlitErase(const npSprite_t *s, int x, int y)
+{
+    npBlit(s, x, y, 0, 0, 0);
+}
@@ -0,0 +1,29 @@
+#ifndef NP_SPRITE_H
+#define NP_SPRITE_H
+
+#include <stdint.h>
+#include "neopixel.h"
+#include "np_anim.h"
+
+// Sprites de 1 bit por pixel: até 32 pixels numa palavra (um painel 5x5 inteiro
+// cabe em uma). O bit y * w + x é o pixel (x, y), com y = 0 embaixo, como em
+// np_layout.h. Os blits passam pela tabela da matriz e recortam nas bordas.
+
+typedef struct
+{
+    uint8_t w, h; // w * h <= 32
+    uint32_t bits;
+} npSprite_t;
+
+// Uma linha de 5 pixels, da esquerda para a direita.
+#define NP_ROW5(a, b, c, d, e) ((a) | (b) << 1 | (c) << 2 | (d) << 3 | (e) << 4)
+
+// Sprite 5x5 escrito como se vê: linha de cima primeiro.
+#define NP_SPRITE5(r4, r3, r2, r1, r0) \
+    {5, 5, (uint32_t)(r0) | (uint32_t)(r1) << 5 | (uint32_t)(r2) << 10 | (uint32_t)(r3) << 15 | (uint32_t)(r4) << 20}
+
+void npBlit(const npSprite_t *s, int x, int y, uint8_t r, uint8_t g, uint8_t b);
+void npBlitPalette(const npSprite_t *planes, uint count, const npColor_t *palette, int x, int y);
+void npBlitErase(const npSprite_t *s, int x, int y);
+
+#endif
@@ -0,0 +1,325 @@
+#include <string.h>
+#include "np_stream.h"
+#ifndef NP_HOST
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#endif
+
+// Estados do leitor de pacotes.
+enum
+{
+    NPS_HEADER,  // 'N' 'P' tipo len
+    NPS_AUX,     // 2 bytes: primeiro LED ('R') ou pula, n ('D')
+    NPS_PIXELS,  // span pixels a partir de cursor, direto em leds[]
+    NPS_DISCARD, // resto inválido do payload, ignorado
+    NPS_SUM,     // XOR do payload
+};
+
+// Destino dos bytes ignorados (pixels fora da cadeia ou resto inválido do payload).
+static uint8_t discard[64];
+
+/**
+ * Envia os contadores ao host ('K').
+ */
+static void npStreamStatus(npStream_t *s)
+{
+    const uint32_t v[3] = {s->stats.received, s->stats.displayed, s->stats.dropped};
+    uint8_t p[5 + sizeof(v) + 1] = {NP_STREAM_MAGIC0, NP_STREAM_MAGIC1, NP_STREAM_STATUS, sizeof(v), 0};
+    uint8_t sum = 0;
+
+    for (uint i = 0; i < sizeof(v); i++)
+    {
+        p[5 + i] = (uint8_t)(v[i / 4] >> (8 * (i % 4)));
+        sum ^= p[5 + i];
+    }
+    p[sizeof(p) - 1] = sum;
+    s->write(p, sizeof(p));
+}
+
+/**
+ * Entra no modo ao vivo. O quadro atual continua em leds[] até chegar o primeiro.
+ */
+void npStreamStart(npStream_t *s, npStreamRead_t read, npStreamWrite_t write)
+{
+    memset(s, 0, sizeof(*s));
+    s->read = read;
+    s->write = write;
+    s->active = true;
+    s->last_rx_us = npHalTimeUs();
+    npStreamStatus(s); // Avisa o host que já pode enviar.
+}
+
+bool npStreamActive(const npStream_t *s)
+{
+    return s->active;
+}
+
+/**
+ * Copia os contadores de quadros recebidos, exibidos e descartados.
+ */
+void npStreamGetStats(const npStream_t *s, npStreamStats_t *out)
+{
+    *out = s->stats;
+}
+
+/**
+ * Onde os próximos bytes devem cair e quantos no máximo.
+ */
+static uint npStreamWant(npStream_t *s, uint8_t **dst)
+{
+    uint n;
+
+    switch (s->state)
+    {
+    case NPS_HEADER:
+        *dst = &s->hdr[s->hdr_len];
+        return 5 - s->hdr_len;
+    case NPS_AUX:
+        *dst = &s->hdr[s->hdr_len];
+        return 2 - s->hdr_len;
+    case NPS_SUM:
+        *dst = s->hdr;
+        return 1;
+    case NPS_PIXELS:
+        if (s->cursor < LED_COUNT)
+        {
+            *dst = (uint8_t *)&leds[s->cursor] + s->pix_byte;
+#if NP_PACKED_PIXELS
+            return 3 - s->pix_byte; // O quarto byte da palavra fica zerado.
+#else
+            n = s->span < LED_COUNT - s->cursor ? s->span : LED_COUNT - s->cursor;
+            return 3 * n - s->pix_byte;
+#endif
+        }
+        n = 3u * s->span - s->pix_byte;
+        break;
+    default:
+        n = s->left;
+        break;
+    }
+    *dst = discard;
+    return n < sizeof(discard) ? n : sizeof(discard);
+}
+
+/**
+ * Depois de um trecho de pixels: outro trecho ('D'), o XOR ou o resto inválido do payload.
+ */
+static void npStreamNext(npStream_t *s)
+{
+    s->hdr_len = 0;
+    if (s->left == 0)
+        s->state = NPS_SUM;
+    else if (s->type == NP_STREAM_DELTA && s->left >= 2)
+        s->state = NPS_AUX;
+    else
+    {
+        s->bad = true;
+        s->state = NPS_DISCARD;
+    }
+}
+
+/**
+ * Cabeçalho plausível: tipo conhecido e tamanho possível para LED_COUNT. Sem
+ * isso, um 'N' 'P' qualquer no meio dos pixels faria a procura engolir até 64KB.
+ */
+static bool npStreamHeaderOk(const uint8_t *h)
+{
+    uint len = h[3] | h[4] << 8;
+
+    switch (h[2])
+    {
+    case NP_STREAM_RAW:
+    case NP_STREAM_DELTA:
+        return len <= NP_STREAM_MAX_PAYLOAD;
+    case NP_STREAM_SYNC:
+    case NP_STREAM_EXIT:
+        return len == 0;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Cabeçalho completo: escolhe como ler o payload.
+ */
+static void npStreamBegin(npStream_t *s)
+{
+    s->type = s->hdr[2];
+    s->left = (uint16_t)(s->hdr[3] | s->hdr[4] << 8);
+    s->sum = 0;
+    s->hdr_len = 0;
+    s->cursor = 0; // Os trechos de 'D' contam a partir do LED 0.
+
+    if (s->left == 0)
+        s->state = NPS_SUM;
+    else if (s->type == NP_STREAM_RAW && s->left >= 2)
+        s->state = NPS_AUX;
+    else
+        npStreamNext(s);
+}
+
+/**
+ * Fim do pacote: o marcador fecha o quadro, que é exibido ou descartado.
+ */
+static void npStreamEnd(npStream_t *s, bool ok)
+{
+    if (!ok)
+        s->bad = true;
+
+    if (s->type == NP_STREAM_SYNC)
+    {
+        s->stats.received++;
+        if (s->bad)
+        {
+            s->stats.dropped++;
+            npStreamStatus(s); // O host vê o descarte e manda um quadro cru.
+        }
+        else
+            s->pending = true;
+        s->bad = false;
+    }
+    else if (s->type == NP_STREAM_EXIT && ok)
+        s->active = false;
+}
+
+/**
+ * Avança o leitor com n bytes recém-lidos em p (p aponta para onde npStreamWant mandou).
+ */
+static void npStreamConsume(npStream_t *s, const uint8_t *p, uint n)
+{
+    if (s->state != NPS_HEADER && s->state != NPS_SUM)
+    {
+        for (uint i = 0; i < n; i++)
+            s->sum ^= p[i];
+        s->left -= (uint16_t)n;
+    }
+
+    switch (s->state)
+    {
+    case NPS_HEADER:
+        s->hdr_len += (uint8_t)n;
+        // Fora de sincronia (host reiniciado no meio de um pacote): procura o próximo cabeçalho.
+        while (s->hdr_len && (s->hdr[0] != NP_STREAM_MAGIC0 || (s->hdr_len > 1 && s->hdr[1] != NP_STREAM_MAGIC1) ||
+                              (s->hdr_len == 5 && !npStreamHeaderOk(s->hdr))))
+        {
+            memmove(s->hdr, s->hdr + 1, --s->hdr_len);
+            s->bad = true;
+        }
+        if (s->hdr_len == 5)
+            npStreamBegin(s);
+        break;
+    case NPS_AUX:
+        s->hdr_len += (uint8_t)n;
+        if (s->hdr_len < 2)
+            break;
+        if (s->type == NP_STREAM_RAW)
+        {
+            s->cursor = (uint32_t)(s->hdr[0] | s->hdr[1] << 8);
+            s->span = s->left / 3;
+        }
+        else
+        {
+            s->cursor += s->hdr[0];
+            s->span = s->hdr[1];
+            if (3u * s->span > s->left)
+            {
+                s->bad = true;
+                s->span = s->left / 3;
+            }
+        }
+        s->pix_byte = 0;
+        if (s->span)
+            s->state = NPS_PIXELS;
+        else
+            npStreamNext(s);
+        break;
+    case NPS_PIXELS:
+        if (s->cursor >= LED_COUNT)
+            s->bad = true;
+        n += s->pix_byte;
+        s->cursor += n / 3;
+        s->span -= (uint16_t)(n / 3);
+        s->pix_byte = (uint8_t)(n % 3);
+        if (s->span == 0)
+            npStreamNext(s);
+        break;
+    case NPS_DISCARD:
+        if (s->left == 0)
+            s->state = NPS_SUM;
+        break;
+    default:
+        npStreamEnd(s, p[0] == s->sum);
+        s->state = NPS_HEADER;
+        s->hdr_len = 0;
+        break;
+    }
+}
+
+/**
+ * Mostra o quadro pendente assim que o anterior liberar o fio.
+ */
+static void npStreamShow(npStream_t *s)
+{
+    if (!npWriteDone())
+        return;
+    npMarkDirty(); // Os pixels chegaram direto em leds[], sem passar por npSetLED.
+    npWrite();
+    s->pending = false;
+    s->stats.displayed++;
+    npStreamStatus(s);
+}
+
+/**
+ * Lê o que chegou (até NP_STREAM_BUDGET bytes) e mostra o quadro fechado por 'S'.
+ * Com um quadro pendente não lê nada: é o controle de fluxo.
+ * Retorna o tempo até a próxima leitura em us, ou -1 quando o modo ao vivo terminou.
+ */
+int32_t npStreamStep(npStream_t *s)
+{
+    uint64_t now = npHalTimeUs();
+    uint budget = NP_STREAM_BUDGET;
+
+    if (s->pending)
+        npStreamShow(s);
+    while (s->active && !s->pending && budget)
+    {
+        uint8_t *dst;
+        uint max = npStreamWant(s, &dst);
+        int n = s->read(dst, max < budget ? max : budget);
+        if (n < 0)
+            s->active = false;
+        if (n <= 0)
+            break;
+        npStreamConsume(s, dst, (uint)n);
+        budget -= (uint)n;
+        s->last_rx_us = now;
+        if (s->pending)
+            npStreamShow(s);
+    }
+
+    if (now - s->last_rx_us > NP_STREAM_TIMEOUT_US)
+        s->active = false;
+    return s->active ? NP_STREAM_POLL_US : -1;
+}
+
+#ifndef NP_HOST
+/**
+ * Leitura direta da FIFO de RX da TinyUSB para dst (o driver de stdio cuida do mutex).
+ */
+int npStreamUsbRead(void *dst, uint max)
+{
+    if (!stdio_usb_connected())
+        return -1;
+    int n = stdio_usb.in_chars((char *)dst, (int)max);
+    return n > 0 ? n : 0;
+}
+
+/**
+ * Resposta ao host, só se couber inteira no buffer da TinyUSB (nunca espera).
+ */
+void npStreamUsbWrite(const void *src, uint len)
+{
+    if (stdio_usb_connected() && tud_cdc_write_available() >= len)
+        stdio_usb.out_chars((const char *)src, (int)len);
+}
+#endif
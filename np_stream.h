@@ -0,0 +1,87 @@
+#ifndef NP_STREAM_H
+#define NP_STREAM_H
+
+#include "neopixel.h"
+
+// Modo ao vivo: o host envia os quadros pela USB CDC e a placa só os mostra.
+// Pacote (nos dois sentidos): 'N' 'P' tipo len(16 bits, LE) payload XOR(payload).
+//
+//   'R' primeiro(16 bits) GRB...    quadro cru: pixels a partir do LED primeiro
+//   'D' { pula n GRB[n] }...        quadro delta: avança pula LEDs e grava os n seguintes
+//   'S'                             marcador de quadro: mostra o que foi recebido
+//   'X'                             volta ao modo de comandos
+//   'K' recebidos exibidos descartados   (placa -> host) npStreamStats_t, 32 bits LE
+//
+// Os pixels vêm na ordem G, R, B de npLED_t e a posição é o índice na cadeia.
+// Eles vão direto da FIFO da USB para leds[] (o buffer de desenho; o quadro no
+// fio está em outro buffer), sem cópia intermediária. Com um quadro esperando o
+// fio a placa para de ler e a USB segura o host (NAK); o 'K' a cada quadro
+// exibido diz ao host quantos quadros estão em trânsito.
+// Quadro com pacote corrompido é descartado no 'S' (o host deve mandar um cru).
+// Remetente: host/np_stream_send.c.
+
+#define NP_STREAM_MAGIC0 'N'
+#define NP_STREAM_MAGIC1 'P'
+#define NP_STREAM_RAW 'R'
+#define NP_STREAM_DELTA 'D'
+#define NP_STREAM_SYNC 'S'
+#define NP_STREAM_EXIT 'X'
+#define NP_STREAM_STATUS 'K'
+
+// Maior payload aceito: 'D' com todos os LEDs alterados (3 bytes por LED e 2 por
+// trecho de até 255). Cabeçalho com tamanho maior conta como perda de sincronia.
+#define NP_STREAM_MAX_PAYLOAD (3 * LED_COUNT + 2 * (LED_COUNT / 255 + 1) + 2)
+
+// Comando do laço principal que entra no modo ao vivo.
+#define NP_STREAM_CMD '8'
+
+// Período de leitura da USB e bytes lidos por passo (o resto fica para o próximo).
+#define NP_STREAM_POLL_US 1000
+#define NP_STREAM_BUDGET 4096
+
+// Sem nenhum byte por esse tempo, volta ao modo de comandos.
+#define NP_STREAM_TIMEOUT_US 3000000
+
+typedef struct
+{
+    uint32_t received;  // Quadros fechados por 'S'.
+    uint32_t displayed; // Quadros enviados aos LEDs.
+    uint32_t dropped;   // Quadros descartados (pacote corrompido ou fora da cadeia).
+} npStreamStats_t;
+
+// Lê até max bytes em dst: retorna quantos leu, 0 sem dados ou < 0 com a conexão fechada.
+typedef int (*npStreamRead_t)(void *dst, uint max);
+// Envia uma resposta inteira ou nada (a próxima traz os contadores atualizados).
+typedef void (*npStreamWrite_t)(const void *src, uint len);
+
+typedef struct
+{
+    npStreamRead_t read;
+    npStreamWrite_t write;
+    npStreamStats_t stats;
+    uint64_t last_rx_us;
+    uint8_t state;
+    uint8_t type;    // Tipo do pacote em andamento.
+    uint8_t sum;     // XOR do payload recebido até aqui.
+    uint8_t hdr[5];  // Cabeçalho; também recebe os 2 bytes de 'R'/'D' e o XOR.
+    uint8_t hdr_len;
+    uint8_t pix_byte; // Bytes já recebidos do pixel atual.
+    uint16_t left;    // Bytes do payload que faltam.
+    uint16_t span;    // Pixels que faltam no trecho.
+    uint32_t cursor;  // Próximo LED.
+    bool bad;         // O quadro em recepção perdeu algum pacote.
+    bool pending;     // Quadro completo esperando o fio.
+    bool active;
+} npStream_t;
+
+void npStreamStart(npStream_t *s, npStreamRead_t read, npStreamWrite_t write);
+int32_t npStreamStep(npStream_t *s);
+bool npStreamActive(const npStream_t *s);
+void npStreamGetStats(const npStream_t *s, npStreamStats_t *stats);
+
+#ifndef NP_HOST
+int npStreamUsbRead(void *dst, uint max);
+void npStreamUsbWrite(const void *src, uint len);
+#endif
+
+#endif
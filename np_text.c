@@ -0,0 +1,176 @@
+#include "np_text.h"
+#include "np_layout.h"
+
+// Fonte 5x5 proporcional, ASCII 32 a 95 (minúsculas usam as maiúsculas).
+// Cada glifo é a largura seguida das colunas da esquerda para a direita;
+// o bit y de uma coluna é a linha y, com o bit 4 em cima.
+const npGlyph_t np_font5x5[NP_FONT_GLYPHS] = {
+    {2, {0x00, 0x00, 0x00, 0x00, 0x00}}, // ' '
+    {1, {0x1D, 0x00, 0x00, 0x00, 0x00}}, // '!'
+    {3, {0x18, 0x00, 0x18, 0x00, 0x00}}, // '"'
+    {5, {0x0A, 0x1F, 0x0A, 0x1F, 0x0A}}, // '#'
+    {5, {0x09, 0x15, 0x1F, 0x15, 0x12}}, // '$'
+    {5, {0x19, 0x1A, 0x04, 0x0B, 0x13}}, // '%'
+    {5, {0x0A, 0x15, 0x15, 0x0A, 0x05}}, // '&'
+    {1, {0x18, 0x00, 0x00, 0x00, 0x00}}, // '\''
+    {2, {0x0E, 0x11, 0x00, 0x00, 0x00}}, // '('
+    {2, {0x11, 0x0E, 0x00, 0x00, 0x00}}, // ')'
+    {3, {0x14, 0x08, 0x14, 0x00, 0x00}}, // '*'
+    {3, {0x04, 0x0E, 0x04, 0x00, 0x00}}, // '+'
+    {2, {0x01, 0x02, 0x00, 0x00, 0x00}}, // ','
+    {3, {0x04, 0x04, 0x04, 0x00, 0x00}}, // '-'
+    {1, {0x01, 0x00, 0x00, 0x00, 0x00}}, // '.'
+    {5, {0x01, 0x02, 0x04, 0x08, 0x10}}, // '/'
+    {5, {0x0E, 0x13, 0x15, 0x19, 0x0E}}, // '0'
+    {3, {0x09, 0x1F, 0x01, 0x00, 0x00}}, // '1'
+    {4, {0x13, 0x15, 0x15, 0x09, 0x00}}, // '2'
+    {4, {0x11, 0x15, 0x15, 0x0A, 0x00}}, // '3'
+    {4, {0x1C, 0x04, 0x04, 0x1F, 0x00}}, // '4'
+    {4, {0x1D, 0x15, 0x15, 0x12, 0x00}}, // '5'
+    {4, {0x0E, 0x15, 0x15, 0x02, 0x00}}, // '6'
+    {4, {0x10, 0x13, 0x14, 0x18, 0x00}}, // '7'
+    {4, {0x0A, 0x15, 0x15, 0x0A, 0x00}}, // '8'
+    {4, {0x08, 0x15, 0x15, 0x0E, 0x00}}, // '9'
+    {1, {0x0A, 0x00, 0x00, 0x00, 0x00}}, // ':'
+    {2, {0x01, 0x0A, 0x00, 0x00, 0x00}}, // ';'
+    {3, {0x04, 0x0A, 0x11, 0x00, 0x00}}, // '<'
+    {3, {0x0A, 0x0A, 0x0A, 0x00, 0x00}}, // '='
+    {3, {0x11, 0x0A, 0x04, 0x00, 0x00}}, // '>'
+    {4, {0x10, 0x15, 0x14, 0x08, 0x00}}, // '?'
+    {5, {0x0E, 0x11, 0x17, 0x15, 0x0E}}, // '@'
+    {4, {0x0F, 0x14, 0x14, 0x0F, 0x00}}, // 'A'
+    {4, {0x1F, 0x15, 0x15, 0x0A, 0x00}}, // 'B'
+    {4, {0x0E, 0x11, 0x11, 0x11, 0x00}}, // 'C'
+    {4, {0x1F, 0x11, 0x11, 0x0E, 0x00}}, // 'D'
+    {4, {0x1F, 0x15, 0x15, 0x11, 0x00}}, // 'E'
+    {4, {0x1F, 0x14, 0x14, 0x10, 0x00}}, // 'F'
+    {4, {0x0E, 0x11, 0x15, 0x17, 0x00}}, // 'G'
+    {4, {0x1F, 0x04, 0x04, 0x1F, 0x00}}, // 'H'
+    {3, {0x11, 0x1F, 0x11, 0x00, 0x00}}, // 'I'
+    {4, {0x02, 0x01, 0x11, 0x1E, 0x00}}, // 'J'
+    {4, {0x1F, 0x04, 0x0A, 0x11, 0x00}}, // 'K'
+    {4, {0x1F, 0x01, 0x01, 0x01, 0x00}}, // 'L'
+    {5, {0x1F, 0x08, 0x04, 0x08, 0x1F}}, // 'M'
+    {5, {0x1F, 0x08, 0x04, 0x02, 0x1F}}, // 'N'
+    {4, {0x0E, 0x11, 0x11, 0x0E, 0x00}}, // 'O'
+    {4, {0x1F, 0x14, 0x14, 0x08, 0x00}}, // 'P'
+    {5, {0x0E, 0x11, 0x13, 0x0E, 0x01}}, // 'Q'
+    {4, {0x1F, 0x14, 0x16, 0x09, 0x00}}, // 'R'
+    {4, {0x09, 0x15, 0x15, 0x12, 0x00}}, // 'S'
+    {5, {0x10, 0x10, 0x1F, 0x10, 0x10}}, // 'T'
+    {4, {0x1E, 0x01, 0x01, 0x1E, 0x00}}, // 'U'
+    {5, {0x1C, 0x02, 0x01, 0x02, 0x1C}}, // 'V'
+    {5, {0x1F, 0x02, 0x04, 0x02, 0x1F}}, // 'W'
+    {5, {0x11, 0x0A, 0x04, 0x0A, 0x11}}, // 'X'
+    {5, {0x10, 0x08, 0x07, 0x08, 0x10}}, // 'Y'
+    {5, {0x11, 0x13, 0x15, 0x19, 0x11}}, // 'Z'
+    {2, {0x1F, 0x11, 0x00, 0x00, 0x00}}, // '['
+    {5, {0x10, 0x08, 0x04, 0x02, 0x01}}, // '\\'
+    {2, {0x11, 0x1F, 0x00, 0x00, 0x00}}, // ']'
+    {3, {0x08, 0x10, 0x08, 0x00, 0x00}}, // '^'
+    {4, {0x01, 0x01, 0x01, 0x01, 0x00}}, // '_'
+};
+
+/**
+ * Glifo de um caractere; minúsculas viram maiúsculas e o resto vira '?'.
+ */
+static const npGlyph_t *npTextGlyph(char ch)
+{
+    uint8_t c = (uint8_t)ch;
+
+    if (c >= 'a' && c <= 'z')
+        c -= 'a' - 'A';
+    if (c < NP_FONT_FIRST || c >= NP_FONT_FIRST + NP_FONT_GLYPHS)
+        c = '?';
+    return &np_font5x5[c - NP_FONT_FIRST];
+}
+
+/**
+ * Converte o texto no fluxo de colunas do letreiro: as colunas de cada glifo
+ * com uma coluna apagada entre eles e NP_WIDTH colunas apagadas no fim, para a
+ * mensagem sair da tela antes de recomeçar. Retorna o número de colunas
+ * (0 se não couber em size).
+ */
+uint npTextColumns(uint8_t *cols, uint size, const char *text)
+{
+    uint n = 0;
+
+    for (; *text; text++)
+    {
+        const npGlyph_t *g = npTextGlyph(*text);
+        if (n + g->width + 1 > size)
+            return 0;
+        for (uint x = 0; x < g->width; x++)
+            cols[n++] = g->cols[x];
+        cols[n++] = 0;
+    }
+    if (n + NP_WIDTH > size)
+        return 0;
+    for (uint x = 0; x < NP_WIDTH; x++)
+        cols[n++] = 0;
+    return n;
+}
+
+/**
+ * Prepara o letreiro; a primeira tela é a lacuna do fim do fluxo, então o texto
+ * entra pela direita. loops = 0 repete para sempre.
+ */
+void npMarqueeStart(npMarquee_t *m, const uint8_t *cols, uint16_t len, npColor_t color, uint16_t col_ms, uint8_t loops)
+{
+    m->cols = cols;
+    m->len = len;
+    m->pos = len > NP_WIDTH ? len - NP_WIDTH : 0;
+    m->step = 0;
+    m->color = color;
+    m->col_ms = col_ms;
+    m->loops = loops;
+    m->loop = 0;
+}
+
+/**
+ * Desenha a janela atual (NP_WIDTH colunas a partir de pos, circular) nas linhas
+ * centrais da matriz. O custo é o mesmo em qualquer ponto da mensagem.
+ */
+void npMarqueeRender(const npMarquee_t *m)
+{
+    const uint8_t r = m->color.r, g = m->color.g, b = m->color.b;
+    const uint y0 = (NP_HEIGHT - NP_FONT_H) / 2;
+    uint c = m->pos;
+
+    for (uint x = 0; x < NP_WIDTH; x++)
+    {
+        uint8_t bits = m->cols[c];
+        for (uint y = 0; y < NP_FONT_H; y++, bits >>= 1)
+        {
+            uint i = np_layout[(y0 + y) * NP_WIDTH + x];
+            if (bits & 1)
+                npSetLED(i, r, g, b);
+            else
+                npSetLED(i, 0, 0, 0);
+        }
+        if (++c == m->len)
+            c = 0;
+    }
+}
+
+/**
+ * Desenha e envia a janela atual e avança uma coluna, sem esperar.
+ * Retorna o tempo até o próximo passo em ms, ou -1 quando as voltas terminaram.
+ */
+int32_t npMarqueeStep(npMarquee_t *m)
+{
+    if (m->len == 0 || (m->loops && m->loop >= m->loops))
+        return -1;
+
+    npMarqueeRender(m);
+    npWrite();
+
+    if (++m->pos == m->len)
+        m->pos = 0;
+    if (++m->step == m->len)
+    {
+        m->step = 0;
+        m->loop++;
+    }
+    return m->col_ms;
+}
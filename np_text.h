@@ -0,0 +1,42 @@
+#ifndef NP_TEXT_H
+#define NP_TEXT_H
+
+#include <stdint.h>
+#include "neopixel.h"
+#include "np_anim.h"
+
+// Letreiro: o texto é convertido uma vez num fluxo de colunas (um byte por
+// coluna, bit y = linha y) e cada passo só desloca a janela de NP_WIDTH colunas
+// sobre ele. Mensagens longas custam o mesmo por quadro que as curtas.
+
+#define NP_FONT_H 5
+#define NP_FONT_FIRST ' '
+#define NP_FONT_GLYPHS 64
+
+typedef struct
+{
+    uint8_t width; // Colunas usadas (a separação entre letras é acrescentada no fluxo).
+    uint8_t cols[NP_FONT_H];
+} npGlyph_t;
+
+extern const npGlyph_t np_font5x5[NP_FONT_GLYPHS];
+
+// Estado de reprodução do letreiro.
+typedef struct
+{
+    const uint8_t *cols; // Fluxo de colunas de npTextColumns().
+    uint16_t len;
+    uint16_t pos;  // Primeira coluna da janela.
+    uint16_t step; // Colunas avançadas na volta atual.
+    npColor_t color;
+    uint16_t col_ms; // Tempo de cada passo de uma coluna.
+    uint8_t loops;   // 0 = infinito.
+    uint8_t loop;
+} npMarquee_t;
+
+uint npTextColumns(uint8_t *cols, uint size, const char *text);
+void npMarqueeStart(npMarquee_t *m, const uint8_t *cols, uint16_t len, npColor_t color, uint16_t col_ms, uint8_t loops);
+void npMarqueeRender(const npMarquee_t *m);
+int32_t npMarqueeStep(npMarquee_t *m);
+
+#endif
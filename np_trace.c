@@ -0,0 +1,113 @@
+#include <string.h>
+#include "np_trace.h"
+#ifndef NP_HOST
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#endif
+
+npTraceRing_t np_trace_rings[NP_TRACE_CORES];
+
+// Perdas já informadas por anel (quem drena não zera o contador do produtor).
+static uint32_t dropped_reported[NP_TRACE_CORES];
+
+/**
+ * Monta um pacote com até n eventos a partir de recs; retorna o tamanho.
+ */
+static uint npTracePacket(uint8_t *buf, const npTraceRecord_t *recs, uint n)
+{
+    uint8_t sum = 0;
+
+    buf[0] = NP_TRACE_SYNC0;
+    buf[1] = NP_TRACE_SYNC1;
+    buf[2] = (uint8_t)n;
+    for (uint i = 0; i < n; i++)
+    {
+        uint8_t *p = &buf[3 + 8 * i];
+        p[0] = (uint8_t)recs[i].t_us;
+        p[1] = (uint8_t)(recs[i].t_us >> 8);
+        p[2] = (uint8_t)(recs[i].t_us >> 16);
+        p[3] = (uint8_t)(recs[i].t_us >> 24);
+        p[4] = recs[i].type;
+        p[5] = recs[i].a;
+        p[6] = (uint8_t)recs[i].b;
+        p[7] = (uint8_t)(recs[i].b >> 8);
+        for (uint k = 0; k < 8; k++)
+            sum ^= p[k];
+    }
+    buf[3 + 8 * n] = sum;
+    return 4 + 8 * n;
+}
+
+/**
+ * Retira eventos dos anéis e monta pacotes em buf (no máximo size bytes).
+ * Retorna o número de bytes escritos. Só pode ser chamada de um contexto.
+ */
+uint npTraceDrain(uint8_t *buf, uint size)
+{
+    npTraceRecord_t recs[NP_TRACE_PACKET_EVENTS];
+    uint len = 0;
+
+    for (uint core = 0; core < NP_TRACE_CORES; core++)
+    {
+        npTraceRing_t *r = &np_trace_rings[core];
+
+        while (size - len >= NP_TRACE_PACKET_MAX)
+        {
+            uint n = 0;
+
+            uint32_t dropped = r->dropped;
+            if (dropped != dropped_reported[core])
+            {
+                recs[n].t_us = NP_TRACE_NOW();
+                recs[n].type = (uint8_t)(NP_EV_DROPPED | core << 7);
+                recs[n].a = 0;
+                recs[n].b = (uint16_t)(dropped - dropped_reported[core]);
+                dropped_reported[core] = dropped;
+                n++;
+            }
+
+            uint32_t tail = r->tail, head = r->head;
+            NP_TRACE_BARRIER();
+            while (n < NP_TRACE_PACKET_EVENTS && tail != head)
+                recs[n++] = r->rec[tail++ & (NP_TRACE_SIZE - 1)];
+            NP_TRACE_BARRIER();
+            r->tail = tail;
+
+            if (n == 0)
+                break;
+            len += npTracePacket(&buf[len], recs, n);
+        }
+    }
+    return len;
+}
+
+#ifndef NP_HOST
+static npTraceBusy_t trace_busy;
+
+/**
+ * Registra quem diz se a USB está ocupada por um protocolo (NULL: nunca).
+ */
+void npTraceSetBusy(npTraceBusy_t busy)
+{
+    trace_busy = busy;
+}
+
+/**
+ * Tarefa do escalonador: envia pela USB CDC só o que cabe no buffer da TinyUSB,
+ * então nunca espera o host. Sem terminal aberto, ou com a USB ocupada por um
+ * protocolo (npTraceSetBusy), os eventos ficam no anel.
+ */
+int32_t npTraceTask(void *ctx)
+{
+    static uint8_t buf[4 * NP_TRACE_PACKET_MAX];
+
+    if (stdio_usb_connected() && !(trace_busy && trace_busy()))
+    {
+        uint avail = tud_cdc_write_available();
+        uint len = npTraceDrain(buf, avail < sizeof(buf) ? avail : sizeof(buf));
+        if (len)
+            stdio_usb.out_chars((const char *)buf, (int)len);
+    }
+    return NP_TRACE_DRAIN_US;
+}
+#endif
@@ -0,0 +1,126 @@
+#ifndef NP_TRACE_H
+#define NP_TRACE_H
+
+#include "neopixel.h"
+#ifndef NP_HOST
+#include "hardware/sync.h"
+#endif
+
+// Telemetria binária: eventos de 8 bytes gravados num anel em RAM (um por core)
+// e drenados em pacotes por uma tarefa do escalonador para a USB CDC.
+// Gravar um evento custa algumas instruções com as interrupções mascaradas;
+// com o anel cheio o evento é descartado e contado, nunca bloqueia.
+// Decodificador: host/np_trace_dump.c.
+
+// 0 remove todas as chamadas de npTrace() na compilação.
+#ifndef NP_TRACE
+#define NP_TRACE 1
+#endif
+
+// Eventos por anel (potência de 2).
+#define NP_TRACE_SIZE 256
+
+// Período da tarefa que drena os anéis.
+#define NP_TRACE_DRAIN_US 20000
+
+// Pacote na serial: 0xA5 0x5A, n, n eventos, XOR dos bytes dos eventos.
+#define NP_TRACE_SYNC0 0xA5
+#define NP_TRACE_SYNC1 0x5A
+#define NP_TRACE_PACKET_EVENTS 16
+#define NP_TRACE_PACKET_MAX (4 + NP_TRACE_PACKET_EVENTS * 8)
+
+typedef enum
+{
+    NP_EV_FRAME_START = 1, // b = número do quadro
+    NP_EV_FRAME_END,       // b = LEDs enviados
+    NP_EV_WRITE,           // b = us de CPU em npWrite()
+    NP_EV_STALL,           // b = us esperando o quadro anterior terminar
+    NP_EV_KEY,             // a = tecla, b = keypad_event_type_t
+    NP_EV_CMD,             // a = comando tratado pelo laço principal
+    NP_EV_TASK,            // a = tarefa, b = us do passo
+    NP_EV_RING_DROP,       // b = quadros descartados pelo anel do core1 (total)
+    NP_EV_RING_LATE,       // b = quadros atrasados no core1 (total)
+    NP_EV_DROPPED,         // b = eventos de telemetria perdidos com o anel cheio
+    NP_EV_FRAME_SKIP,      // npWrite() sem mudanças desde o último quadro
+    NP_EV_MARK,            // livre para depuração
+} npTraceEvent_t;
+
+typedef struct
+{
+    uint32_t t_us;
+    uint8_t type; // npTraceEvent_t; bit 7 = core que gravou
+    uint8_t a;
+    uint16_t b;
+} npTraceRecord_t;
+
+typedef struct
+{
+    npTraceRecord_t rec[NP_TRACE_SIZE];
+    volatile uint32_t head; // Só o core dono escreve.
+    volatile uint32_t tail; // Só quem drena escreve.
+    volatile uint32_t dropped;
+} npTraceRing_t;
+
+#if NP_DUAL_CORE
+#define NP_TRACE_CORES 2
+#else
+#define NP_TRACE_CORES 1
+#endif
+
+extern npTraceRing_t np_trace_rings[NP_TRACE_CORES];
+
+#ifdef NP_HOST
+#define NP_TRACE_NOW() ((uint32_t)npHalTimeUs())
+#define NP_TRACE_CORE() 0
+#define NP_TRACE_LOCK() 0
+#define NP_TRACE_UNLOCK(s) ((void)(s))
+#define NP_TRACE_BARRIER() ((void)0)
+#else
+#define NP_TRACE_NOW() time_us_32()
+#define NP_TRACE_CORE() (NP_TRACE_CORES > 1 ? get_core_num() : 0)
+#define NP_TRACE_LOCK() save_and_disable_interrupts()
+#define NP_TRACE_UNLOCK(s) restore_interrupts(s)
+#define NP_TRACE_BARRIER() __dmb()
+#endif
+
+/**
+ * Grava um evento no anel do core atual (seguro em interrupções).
+ */
+static inline void npTrace(npTraceEvent_t type, uint8_t a, uint16_t b)
+{
+#if NP_TRACE
+    uint core = NP_TRACE_CORE();
+    npTraceRing_t *r = &np_trace_rings[core];
+    uint32_t s = NP_TRACE_LOCK();
+    uint32_t h = r->head;
+
+    if (h - r->tail >= NP_TRACE_SIZE)
+        r->dropped++;
+    else
+    {
+        npTraceRecord_t *e = &r->rec[h & (NP_TRACE_SIZE - 1)];
+        e->t_us = NP_TRACE_NOW();
+        e->type = (uint8_t)(type | core << 7);
+        e->a = a;
+        e->b = b;
+        NP_TRACE_BARRIER();
+        r->head = h + 1;
+    }
+    NP_TRACE_UNLOCK(s);
+#else
+    (void)type;
+    (void)a;
+    (void)b;
+#endif
+}
+
+// Diz se a USB CDC está com um protocolo que espera respostas (modo ao vivo,
+// recepção da biblioteca). Enquanto for true a telemetria fica no anel, para
+// não tomar o espaço de TX de que os 'K'/'A' precisam.
+typedef bool (*npTraceBusy_t)(void);
+
+uint npTraceDrain(uint8_t *buf, uint size);
+void npTraceSetBusy(npTraceBusy_t busy);
+int32_t npTraceTask(void *ctx);
+
+#endif
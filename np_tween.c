@@ -0,0 +1,171 @@
+#include <string.h>
+#include "np_tween.h"
+#if NP_TWEEN_INTERP
+#include "hardware/interp.h"
+#endif
+
+/**
+ * Aplica a curva a t em ponto fixo (0 a 256); o resultado também vai de 0 a 256.
+ */
+uint npEase(npEase_t ease, uint t)
+{
+    switch (ease)
+    {
+    case NP_EASE_IN:
+        return t * t >> 8;
+    case NP_EASE_OUT:
+        return 256 - ((256 - t) * (256 - t) >> 8);
+    case NP_EASE_IN_OUT:
+        return t * t * (768 - 2 * t) >> 16;
+    default:
+        return t;
+    }
+}
+
+#if NP_TWEEN_INTERP
+/**
+ * Modo blend: o resultado da faixa 1 é base0 + (base1 - base0) * accum1 / 256.
+ */
+static void npLerpInit(uint alpha)
+{
+    interp_config c = interp_default_config();
+    interp_config_set_blend(&c, true);
+    interp_set_config(interp0, 0, &c);
+    c = interp_default_config();
+    interp_set_config(interp0, 1, &c);
+    interp0->accum[1] = alpha;
+}
+
+static inline uint8_t npLerp8(uint8_t a, uint8_t b)
+{
+    interp0->base[0] = a;
+    interp0->base[1] = b;
+    return (uint8_t)interp0->peek[1];
+}
+#endif
+
+/**
+ * dst = a + (b - a) * alpha / 256 em cada canal, para count pixels (b NULL = preto).
+ * alpha = 256 copia b; dst pode ser a ou b.
+ */
+void npLerpFrame(npLED_t *dst, const npLED_t *a, const npLED_t *b, uint count, uint alpha)
+{
+    if (alpha >= 256)
+    {
+        if (b)
+            memmove(dst, b, count * sizeof(npLED_t));
+        else
+            memset(dst, 0, count * sizeof(npLED_t));
+        return;
+    }
+
+#if NP_TWEEN_INTERP
+    static const npLED_t preto = {0};
+    npLerpInit(alpha);
+    for (uint i = 0; i < count; i++)
+    {
+        const npLED_t *q = b ? &b[i] : &preto;
+        dst[i].G = npLerp8(a[i].G, q->G);
+        dst[i].R = npLerp8(a[i].R, q->R);
+        dst[i].B = npLerp8(a[i].B, q->B);
+    }
+#elif NP_PACKED_PIXELS
+    // G e B nas faixas de 16 bits de uma multiplicação, R sozinho na outra:
+    // 255 * 256 cabe em 16 bits, então as faixas não se misturam.
+    const uint32_t ia = 256 - alpha;
+    for (uint i = 0; i < count; i++)
+    {
+        uint32_t wa = a[i].GRB, wb = b ? b[i].GRB : 0;
+        uint32_t gb = ((wa & 0x00FF00FF) * ia + (wb & 0x00FF00FF) * alpha) >> 8 & 0x00FF00FF;
+        uint32_t r = ((wa >> 8 & 0xFF) * ia + (wb >> 8 & 0xFF) * alpha) & 0xFF00;
+        dst[i].GRB = gb | r;
+    }
+#else
+    const uint ia = 256 - alpha;
+    for (uint i = 0; i < count; i++)
+    {
+        uint8_t g = b ? b[i].G : 0, r = b ? b[i].R : 0, bb = b ? b[i].B : 0;
+        dst[i].G = (uint8_t)((a[i].G * ia + g * alpha) >> 8);
+        dst[i].R = (uint8_t)((a[i].R * ia + r * alpha) >> 8);
+        dst[i].B = (uint8_t)((a[i].B * ia + bb * alpha) >> 8);
+    }
+#endif
+}
+
+/**
+ * Prepara uma transição de steps passos de step_ms; o passo steps mostra to exato.
+ */
+void npTweenStart(npTween_t *t, const npLED_t *from, const npLED_t *to, uint16_t steps, uint16_t step_ms, npEase_t ease)
+{
+    t->from = from;
+    t->to = to;
+    t->steps = steps ? steps : 1;
+    t->step = 0;
+    t->step_ms = step_ms;
+    t->ease = (uint8_t)ease;
+}
+
+/**
+ * Escreve o próximo passo em leds[] e envia, sem esperar.
+ * Retorna o tempo até o próximo passo em ms, ou -1 quando a transição terminou.
+ */
+int32_t npTweenStep(npTween_t *t)
+{
+    if (t->step >= t->steps)
+        return -1;
+
+    t->step++;
+    uint alpha = npEase((npEase_t)t->ease, t->step * 256u / t->steps);
+    npLerpFrame(leds, t->from, t->to, LED_COUNT, alpha);
+    npMarkDirty();
+    npWrite();
+    return t->step_ms;
+}
+
+/**
+ * Configura as transições de um player; steps <= 1 desliga o crossfade.
+ */
+void npTransitionInit(npTransition_t *x, uint8_t steps, npEase_t ease)
+{
+    x->steps = steps;
+    x->ease = (uint8_t)ease;
+    x->tween.steps = x->tween.step = 0;
+    npTransitionCapture(x);
+}
+
+/**
+ * Guarda o quadro atual como origem da próxima transição (ao iniciar um player).
+ */
+void npTransitionCapture(npTransition_t *x)
+{
+    x->cur = 0;
+    memcpy(x->buf[0], leds, sizeof(x->buf[0]));
+}
+
+/**
+ * Chamado depois que o player desenhou um quadro-chave em leds[]: interpola do
+ * quadro anterior até ele ao longo de duration_ms e já envia o primeiro passo.
+ * Retorna o tempo até o próximo passo em ms.
+ */
+int32_t npTransitionBegin(npTransition_t *x, uint32_t duration_ms)
+{
+    if (x->steps <= 1)
+    {
+        npWrite();
+        return (int32_t)duration_ms;
+    }
+
+    uint next = x->cur ^ 1;
+    memcpy(x->buf[next], leds, sizeof(x->buf[next]));
+    npTweenStart(&x->tween, x->buf[x->cur], x->buf[next], x->steps, (uint16_t)(duration_ms / x->steps), (npEase_t)x->ease);
+    x->cur = (uint8_t)next;
+    return npTweenStep(&x->tween);
+}
+
+/**
+ * Próximo passo da transição em andamento; -1 quando não há (o player segue para o próximo quadro).
+ */
+int32_t npTransitionStep(npTransition_t *x)
+{
+    return npTweenStep(&x->tween);
+}
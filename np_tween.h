@@ -0,0 +1,66 @@
+#ifndef NP_TWEEN_H
+#define NP_TWEEN_H
+
+#include <stdint.h>
+#include "neopixel.h"
+
+// Interpolação entre dois quadros (crossfade) com curvas de aceleração.
+// No RP2040 cada canal passa pelo modo blend do interpolador do SIO
+// (NP_TWEEN_INTERP); no host, e com NP_TWEEN_INTERP 0, uma versão em ponto
+// fixo mistura dois canais por multiplicação.
+
+#ifndef NP_TWEEN_INTERP
+#ifdef NP_HOST
+#define NP_TWEEN_INTERP 0
+#else
+#define NP_TWEEN_INTERP 1
+#endif
+#endif
+#if NP_TWEEN_INTERP && defined(NP_HOST)
+#error "NP_TWEEN_INTERP depende do interpolador do SIO do RP2040"
+#endif
+
+// Curvas de aceleração.
+typedef enum
+{
+    NP_EASE_LINEAR,
+    NP_EASE_IN,     // Começa devagar (quadrática).
+    NP_EASE_OUT,    // Termina devagar.
+    NP_EASE_IN_OUT, // Suave nas duas pontas (smoothstep).
+} npEase_t;
+
+// Transição em andamento de from para to (NULL = preto), escrita em leds[].
+typedef struct
+{
+    const npLED_t *from;
+    const npLED_t *to;
+    uint16_t steps;
+    uint16_t step;
+    uint16_t step_ms;
+    uint8_t ease; // npEase_t
+} npTween_t;
+
+// Transições automáticas entre os quadros-chave de um player (np_anim, np_delta):
+// o quadro desenhado vira o destino e o anterior a origem, sem quadros extras em flash.
+struct npTransition_t
+{
+    npLED_t buf[2][LED_COUNT]; // Último destino e o novo.
+    npTween_t tween;
+    uint8_t cur; // buf[cur] = quadro mostrado no fim da última transição.
+    uint8_t steps;
+    uint8_t ease;
+};
+typedef struct npTransition_t npTransition_t;
+
+uint npEase(npEase_t ease, uint t);
+void npLerpFrame(npLED_t *dst, const npLED_t *a, const npLED_t *b, uint count, uint alpha);
+
+void npTweenStart(npTween_t *t, const npLED_t *from, const npLED_t *to, uint16_t steps, uint16_t step_ms, npEase_t ease);
+int32_t npTweenStep(npTween_t *t);
+
+void npTransitionInit(npTransition_t *x, uint8_t steps, npEase_t ease);
+void npTransitionCapture(npTransition_t *x);
+int32_t npTransitionBegin(npTransition_t *x, uint32_t duration_ms);
+int32_t npTransitionStep(npTransition_t *x);
+
+#endif